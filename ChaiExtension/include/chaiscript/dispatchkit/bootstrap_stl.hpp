@@ -13,8 +13,11 @@
 #ifndef CHAISCRIPT_BOOTSTRAP_STL_HPP_
 #define CHAISCRIPT_BOOTSTRAP_STL_HPP_
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -22,6 +25,7 @@
 #include <vector>
 
 #include "bootstrap.hpp"
+#include "boxed_number.hpp"
 #include "boxed_value.hpp"
 #include "dispatchkit.hpp"
 #include "operators.hpp"
@@ -230,6 +234,439 @@ namespace chaiscript
             container.erase(itr);
           }      
 
+
+
+        /// Values the native list algorithms can copy, compare and print without calling back
+        /// into script: the numbers Boxed_Number handles, bools and strings
+        struct Plain_Value
+        {
+          enum Kind { None, Number, Bool, String };
+
+          static Kind kind(const Boxed_Value &t_bv)
+          {
+            const Type_Info &ti = t_bv.get_type_info();
+
+            if (ti.bare_equal(user_type<bool>())) {
+              return Bool;
+            } else if (ti.bare_equal(user_type<std::string>())) {
+              return String;
+            } else if (ti.bare_equal_type_info(typeid(int)) || ti.bare_equal_type_info(typeid(double))
+                || ti.bare_equal_type_info(typeid(long double)) || ti.bare_equal_type_info(typeid(float))
+                || ti.bare_equal_type_info(typeid(char)) || ti.bare_equal_type_info(typeid(unsigned int))
+                || ti.bare_equal_type_info(typeid(long)) || ti.bare_equal_type_info(typeid(unsigned long))
+                || ti.bare_equal_type_info(typeid(std::int8_t)) || ti.bare_equal_type_info(typeid(std::int16_t))
+                || ti.bare_equal_type_info(typeid(std::int32_t)) || ti.bare_equal_type_info(typeid(std::int64_t))
+                || ti.bare_equal_type_info(typeid(std::uint8_t)) || ti.bare_equal_type_info(typeid(std::uint16_t))
+                || ti.bare_equal_type_info(typeid(std::uint32_t)) || ti.bare_equal_type_info(typeid(std::uint64_t))) {
+              return Number;
+            } else {
+              return None;
+            }
+          }
+
+          /// Throws guard_error unless every value in the range is plain, so that the call
+          /// falls through to the prelude version before anything has been done
+          template<typename Itr>
+            static void require(Itr t_begin, Itr t_end)
+            {
+              for (; t_begin != t_end; ++t_begin)
+              {
+                if (kind(*t_begin) == None) {
+                  throw exception::guard_error();
+                }
+              }
+            }
+
+          /// What the prelude's clone() returns for a plain value
+          static Boxed_Value copy(const Boxed_Value &t_bv)
+          {
+            switch (kind(t_bv))
+            {
+              case Number:
+                return Boxed_Number(t_bv).get_as(t_bv.get_type_info()).bv;
+              case Bool:
+                return Boxed_Value(boxed_cast<bool>(t_bv));
+              default:
+                return Boxed_Value(std::string(boxed_cast<const std::string &>(t_bv)));
+            }
+          }
+
+          /// What the prelude's clone() returns for t_bv. Plain values are copied here, anything
+          /// else is passed to the script's clone through t_engine.
+          static Boxed_Value clone(const chaiscript::detail::Dispatch_Engine &t_engine, const Boxed_Value &t_bv)
+          {
+            if (kind(t_bv) != None) {
+              return copy(t_bv);
+            } else {
+              return t_engine.call_function("clone", t_bv);
+            }
+          }
+
+          /// What the prelude's eq() returns for two plain values of the same kind
+          static bool equal(const Boxed_Value &t_lhs, const Boxed_Value &t_rhs)
+          {
+            switch (kind(t_lhs))
+            {
+              case Number:
+                return Boxed_Number::equals(Boxed_Number(t_lhs), Boxed_Number(t_rhs));
+              case Bool:
+                return boxed_cast<bool>(t_lhs) == boxed_cast<bool>(t_rhs);
+              default:
+                return boxed_cast<const std::string &>(t_lhs).get() == boxed_cast<const std::string &>(t_rhs).get();
+            }
+          }
+
+          /// What to_string() returns for a plain value
+          static std::string to_string(const Boxed_Value &t_bv)
+          {
+            const Type_Info &ti = t_bv.get_type_info();
+
+            switch (kind(t_bv))
+            {
+              case Number:
+                // the script level to_string prints character types as characters
+                if (ti.bare_equal_type_info(typeid(char)) || ti.bare_equal_type_info(typeid(std::int8_t))
+                    || ti.bare_equal_type_info(typeid(std::uint8_t))) {
+                  return std::string(1, *static_cast<const char *>(t_bv.get_const_ptr()));
+                }
+                return Boxed_Number(t_bv).to_string();
+              case Bool:
+                return boxed_cast<bool>(t_bv) ? "true" : "false";
+              default:
+                return boxed_cast<const std::string &>(t_bv);
+            }
+          }
+        };
+
+        /// \brief Native versions of the prelude's list algorithms for Vector
+        ///
+        /// They are registered alongside the prelude versions, which remain for every other
+        /// range. Elements the result shares with the input are copied the way the prelude's
+        /// push_back would, which is only possible natively for plain values; for any other
+        /// element type these throw guard_error up front, so the prelude version runs instead.
+        ///
+        /// A script function may return one of its arguments or anything else it can reach, so
+        /// map, foldl and zip_with clone what it returns, as the prelude's push_back and
+        /// assignment do. Cloning anything but a plain value calls the script's clone, so those
+        /// three need the engine and are added by add_cloning_algorithms rather than vector_type.
+        /// Those walk the input by index up to its starting size, so a function that changes the
+        /// input can neither invalidate the walk nor extend it.
+        struct Vector_Algorithms
+        {
+          typedef std::vector<Boxed_Value> Vector;
+          typedef std::function<Boxed_Value (const Boxed_Value &)> Unary;
+          typedef std::function<Boxed_Value (const Boxed_Value &, const Boxed_Value &)> Binary;
+          typedef std::function<bool (const Boxed_Value &)> Predicate;
+          typedef std::function<bool (const Boxed_Value &, const Boxed_Value &)> Compare;
+
+          static Vector map(const chaiscript::detail::Dispatch_Engine &t_engine, const Vector &t_container, const Unary &t_func)
+          {
+            const size_t size = t_container.size();
+
+            Vector retval;
+            retval.reserve(size);
+            for (size_t i = 0; i < size && i < t_container.size(); ++i)
+            {
+              retval.push_back(Plain_Value::clone(t_engine, t_func(t_container[i])));
+            }
+            return retval;
+          }
+
+          static Vector filter(const Vector &t_container, const Predicate &t_pred)
+          {
+            Plain_Value::require(t_container.begin(), t_container.end());
+
+            Vector retval;
+            for (const auto &elem : t_container)
+            {
+              if (t_pred(elem)) {
+                retval.push_back(Plain_Value::copy(elem));
+              }
+            }
+            return retval;
+          }
+
+          static Boxed_Value foldl(const chaiscript::detail::Dispatch_Engine &t_engine, const Vector &t_container, const Binary &t_func, const Boxed_Value &t_initial)
+          {
+            const size_t size = t_container.size();
+
+            Boxed_Value retval = Plain_Value::clone(t_engine, t_initial);
+            for (size_t i = 0; i < size && i < t_container.size(); ++i)
+            {
+              retval = Plain_Value::clone(t_engine, t_func(t_container[i], retval));
+            }
+            return retval;
+          }
+
+          static Boxed_Value sum(const Vector &t_container)
+          {
+            for (const auto &elem : t_container)
+            {
+              if (Plain_Value::kind(elem) != Plain_Value::Number) {
+                throw exception::guard_error();
+              }
+            }
+
+            Boxed_Value retval(0.0);
+            for (const auto &elem : t_container)
+            {
+              retval = Boxed_Number::do_oper(Operators::sum, elem, retval);
+            }
+            return retval;
+          }
+
+          static std::string join(const Vector &t_container, const std::string &t_delim)
+          {
+            Plain_Value::require(t_container.begin(), t_container.end());
+
+            std::string retval;
+            for (auto itr = t_container.begin(); itr != t_container.end(); ++itr)
+            {
+              if (itr != t_container.begin()) {
+                retval += t_delim;
+              }
+              retval += Plain_Value::to_string(*itr);
+            }
+            return retval;
+          }
+
+          static Vector take(const Vector &t_container, int t_num)
+          {
+            return copy(t_container.begin(), t_container.begin() + clamp(t_container, t_num));
+          }
+
+          static Vector drop(const Vector &t_container, int t_num)
+          {
+            return copy(t_container.begin() + clamp(t_container, t_num), t_container.end());
+          }
+
+          static Vector reverse(const Vector &t_container)
+          {
+            return copy(t_container.rbegin(), t_container.rend());
+          }
+
+          static Vector zip_with(const chaiscript::detail::Dispatch_Engine &t_engine, const Binary &t_func, const Vector &t_x, const Vector &t_y)
+          {
+            const size_t size = std::min(t_x.size(), t_y.size());
+
+            Vector retval;
+            retval.reserve(size);
+            for (size_t i = 0; i < size && i < t_x.size() && i < t_y.size(); ++i)
+            {
+              retval.push_back(Plain_Value::clone(t_engine, t_func(t_x[i], t_y[i])));
+            }
+            return retval;
+          }
+
+          static bool contains(const Vector &t_container, const Boxed_Value &t_item)
+          {
+            return position(t_container, t_item) != t_container.size();
+          }
+
+          static bool contains_compare(const Vector &t_container, const Boxed_Value &t_item, const Compare &t_compare)
+          {
+            return position(t_container, t_item, t_compare) != t_container.size();
+          }
+
+          /// Like the prelude, returns a range over the container starting at the first match
+          static Boxed_Value find(const Boxed_Value &t_container, const Boxed_Value &t_item)
+          {
+            Vector &container = boxed_cast<Vector &>(t_container);
+            return range_from(t_container, container, position(container, t_item));
+          }
+
+          static Boxed_Value find_compare(const Boxed_Value &t_container, const Boxed_Value &t_item, const Compare &t_compare)
+          {
+            Vector &container = boxed_cast<Vector &>(t_container);
+            return range_from(t_container, container, position(container, t_item, t_compare));
+          }
+
+          static void add(ModulePtr m)
+          {
+            m->add(fun(&filter), "filter");
+            m->add(fun(&sum), "sum");
+            m->add(fun(&join), "join");
+            m->add(fun(&take), "take");
+            m->add(fun(&drop), "drop");
+            m->add(fun(&reverse), "reverse");
+            m->add(fun(&contains), "contains");
+            m->add(fun(&contains_compare), "contains");
+            m->add(fun(&find), "find");
+            m->add(fun(&find_compare), "find");
+          }
+
+          static void add_cloning(chaiscript::detail::Dispatch_Engine &t_engine)
+          {
+            t_engine.add(fun(&map, std::cref(t_engine)), "map");
+            t_engine.add(fun(&foldl, std::cref(t_engine)), "foldl");
+            t_engine.add(fun(&zip_with, std::cref(t_engine)), "zip_with");
+          }
+
+        private:
+          static size_t clamp(const Vector &t_container, int t_num)
+          {
+            return t_num < 0 ? 0 : std::min(size_t(t_num), t_container.size());
+          }
+
+          template<typename Itr>
+            static Vector copy(Itr t_begin, Itr t_end)
+            {
+              Plain_Value::require(t_begin, t_end);
+
+              Vector retval;
+              retval.reserve(size_t(std::distance(t_begin, t_end)));
+              for (; t_begin != t_end; ++t_begin)
+              {
+                retval.push_back(Plain_Value::copy(*t_begin));
+              }
+              return retval;
+            }
+
+          /// Index of the first element eq() to t_item, or the size of the container
+          static size_t position(const Vector &t_container, const Boxed_Value &t_item)
+          {
+            const Plain_Value::Kind item_kind = Plain_Value::kind(t_item);
+            for (const auto &elem : t_container)
+            {
+              if (item_kind == Plain_Value::None || Plain_Value::kind(elem) != item_kind) {
+                throw exception::guard_error();
+              }
+            }
+
+            for (size_t i = 0; i < t_container.size(); ++i)
+            {
+              if (Plain_Value::equal(t_container[i], t_item)) {
+                return i;
+              }
+            }
+            return t_container.size();
+          }
+
+          static size_t position(const Vector &t_container, const Boxed_Value &t_item, const Compare &t_compare)
+          {
+            for (size_t i = 0; i < t_container.size(); ++i)
+            {
+              if (t_compare(t_container[i], t_item)) {
+                return i;
+              }
+            }
+            return t_container.size();
+          }
+
+          static Boxed_Value range_from(const Boxed_Value &t_container, Vector &t_vector, size_t t_pos)
+          {
+            Bidir_Range<Vector> range(t_vector);
+            std::advance(range.m_begin, t_pos);
+
+            // keeps the container alive for as long as the range, as the prelude's range() does
+            Boxed_Value retval(range);
+            retval.get_attr("internal_obj").assign(t_container);
+            return retval;
+          }
+        };
+
+        /// \brief Native versions of the prelude's list algorithms for Map, see Vector_Algorithms
+        ///
+        /// Elements are passed to script functions as references to the Map_Pair in the map.
+        struct Map_Algorithms
+        {
+          typedef std::map<std::string, Boxed_Value> Map;
+
+          static Vector_Algorithms::Vector map(const chaiscript::detail::Dispatch_Engine &t_engine, Map &t_container, const Vector_Algorithms::Unary &t_func)
+          {
+            Vector_Algorithms::Vector retval;
+            retval.reserve(t_container.size());
+            for (auto &elem : t_container)
+            {
+              retval.push_back(Plain_Value::clone(t_engine, t_func(Boxed_Value(std::ref(elem)))));
+            }
+            return retval;
+          }
+
+          static Map filter(Map &t_container, const Vector_Algorithms::Predicate &t_pred)
+          {
+            for (const auto &elem : t_container)
+            {
+              if (Plain_Value::kind(elem.second) == Plain_Value::None) {
+                throw exception::guard_error();
+              }
+            }
+
+            Map retval;
+            for (auto &elem : t_container)
+            {
+              if (t_pred(Boxed_Value(std::ref(elem)))) {
+                retval.insert(retval.end(), std::make_pair(elem.first, Plain_Value::copy(elem.second)));
+              }
+            }
+            return retval;
+          }
+
+          static Boxed_Value foldl(const chaiscript::detail::Dispatch_Engine &t_engine, Map &t_container, const Vector_Algorithms::Binary &t_func, const Boxed_Value &t_initial)
+          {
+            Boxed_Value retval = Plain_Value::clone(t_engine, t_initial);
+            for (auto &elem : t_container)
+            {
+              retval = Plain_Value::clone(t_engine, t_func(Boxed_Value(std::ref(elem)), retval));
+            }
+            return retval;
+          }
+
+          /// Pairs are printed as "<key, value>", like the prelude's to_string for pairs
+          static std::string join(const Map &t_container, const std::string &t_delim)
+          {
+            for (const auto &elem : t_container)
+            {
+              if (Plain_Value::kind(elem.second) == Plain_Value::None) {
+                throw exception::guard_error();
+              }
+            }
+
+            std::string retval;
+            for (auto itr = t_container.begin(); itr != t_container.end(); ++itr)
+            {
+              if (itr != t_container.begin()) {
+                retval += t_delim;
+              }
+              retval += "<" + itr->first + ", " + Plain_Value::to_string(itr->second) + ">";
+            }
+            return retval;
+          }
+
+          static bool contains(Map &t_container, const Boxed_Value &t_item, const Vector_Algorithms::Compare &t_compare)
+          {
+            for (auto &elem : t_container)
+            {
+              if (t_compare(Boxed_Value(std::ref(elem)), t_item)) {
+                return true;
+              }
+            }
+            return false;
+          }
+
+          static void add(ModulePtr m)
+          {
+            m->add(fun(&filter), "filter");
+            m->add(fun(&join), "join");
+            m->add(fun(&contains), "contains");
+          }
+
+          static void add_cloning(chaiscript::detail::Dispatch_Engine &t_engine)
+          {
+            t_engine.add(fun(&map, std::cref(t_engine)), "map");
+            t_engine.add(fun(&foldl, std::cref(t_engine)), "foldl");
+          }
+        };
+      }
+
+      /// \brief Adds the native map, foldl and zip_with for Vector and Map to t_engine
+      ///
+      /// These clone what the script function returns through t_engine, so unlike the rest of
+      /// the native list algorithms they cannot live in a Module.
+      inline void add_cloning_algorithms(chaiscript::detail::Dispatch_Engine &t_engine)
+      {
+        detail::Vector_Algorithms::add_cloning(t_engine);
+        detail::Map_Algorithms::add_cloning(t_engine);
       }
 
       template<typename ContainerType>
@@ -447,6 +884,11 @@ namespace chaiscript
           pair_associative_container_type<MapType>(type, m);
           input_range_type<MapType>(type, m);
 
+          if (typeid(MapType) == typeid(std::map<std::string, Boxed_Value>))
+          {
+            detail::Map_Algorithms::add(m);
+          }
+
           return m;
         }
 
@@ -514,6 +956,8 @@ namespace chaiscript
                        }
                    } )"
                  );
+
+            detail::Vector_Algorithms::add(m);
           } 
 
           return m;
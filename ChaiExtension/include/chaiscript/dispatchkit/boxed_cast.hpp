@@ -116,6 +116,54 @@ namespace chaiscript
     } 
   }
 
+  namespace detail
+  {
+    /// Non-throwing pre-check for Cast_Helper<Type>. It is conservative: false means that
+    /// boxed_cast<Type> is certain to fail, true means that the cast is worth attempting.
+    /// Specialized alongside any Cast_Helper that accepts other types
+    template<typename Type>
+      struct Cast_Check
+      {
+        static bool can_cast(const Boxed_Value &bv, const Type_Conversions *t_conversions)
+        {
+          return user_type<Type>().bare_equal(bv.get_type_info())
+            || (t_conversions && t_conversions->convertable_type<Type>());
+        }
+      };
+
+    template<>
+      struct Cast_Check<Boxed_Value>
+      {
+        static bool can_cast(const Boxed_Value &, const Type_Conversions *)
+        {
+          return true;
+        }
+      };
+
+    template<>
+      struct Cast_Check<Boxed_Value &> : Cast_Check<Boxed_Value>
+      {
+      };
+
+    template<>
+      struct Cast_Check<const Boxed_Value> : Cast_Check<Boxed_Value>
+      {
+      };
+
+    template<>
+      struct Cast_Check<const Boxed_Value &> : Cast_Check<Boxed_Value>
+      {
+      };
+  }
+
+  /// \brief Tests, without throwing, whether a boxed_cast might succeed
+  /// \returns false if boxed_cast<Type>(bv, t_conversions) is certain to throw exception::bad_boxed_cast
+  template<typename Type>
+  bool can_boxed_cast(const Boxed_Value &bv, const Type_Conversions *t_conversions = nullptr)
+  {
+    return detail::Cast_Check<Type>::can_cast(bv, t_conversions);
+  }
+
 }
 
 
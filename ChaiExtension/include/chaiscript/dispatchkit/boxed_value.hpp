@@ -10,6 +10,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <new>
 #include <type_traits>
 
 #include "../chaiscript_threading.hpp"
@@ -19,6 +20,33 @@
 
 namespace chaiscript 
 {
+  namespace detail
+  {
+    /// Looks up an attribute in an attribute map that may be shared between objects,
+    /// adding it if it does not exist yet. The map is copied first if adding to it would
+    /// otherwise be visible to another object sharing it.
+    template<typename Map>
+      typename Map::mapped_type &get_shared_attr(std::shared_ptr<Map> &t_attrs, const typename Map::key_type &t_name)
+      {
+        if (t_attrs)
+        {
+          auto itr = t_attrs->find(t_name);
+          if (itr != t_attrs->end())
+          {
+            return itr->second;
+          }
+
+          if (t_attrs.use_count() > 1)
+          {
+            t_attrs = std::make_shared<Map>(*t_attrs);
+          }
+        } else {
+          t_attrs = std::make_shared<Map>();
+        }
+
+        return (*t_attrs)[t_name];
+      }
+  }
 
   /// \brief A wrapper for holding any valid C++ type. All types in ChaiScript are Boxed_Value objects
   /// \sa chaiscript::boxed_cast
@@ -31,6 +59,8 @@ namespace chaiscript
       };
 
     private:
+      typedef std::aligned_storage<16>::type Inline_Storage;
+
       /// structure which holds the internal state of a Boxed_Value
       /// \todo Get rid of Any and merge it with this, reducing an allocation in the process
       struct Data
@@ -40,7 +70,7 @@ namespace chaiscript
             bool tr,
             const void *t_void_ptr)
           : m_type_info(ti), m_obj(std::move(to)), m_data_ptr(ti.is_const()?nullptr:const_cast<void *>(t_void_ptr)), m_const_data_ptr(t_void_ptr),
-            m_is_ref(tr)
+            m_is_ref(tr), m_is_inline(false)
         {
         }
 
@@ -49,12 +79,13 @@ namespace chaiscript
           m_type_info = rhs.m_type_info;
           m_obj = rhs.m_obj;
           m_is_ref = rhs.m_is_ref;
+          m_is_inline = rhs.m_is_inline;
           m_data_ptr = rhs.m_data_ptr;
           m_const_data_ptr = rhs.m_const_data_ptr;
 
           if (rhs.m_attrs)
           {
-            m_attrs = std::unique_ptr<std::map<std::string, Boxed_Value>>(new std::map<std::string, Boxed_Value>(*rhs.m_attrs));
+            m_attrs = rhs.m_attrs;
           }
 
           return *this;
@@ -72,10 +103,44 @@ namespace chaiscript
         chaiscript::detail::Any m_obj;
         void *m_data_ptr;
         const void *m_const_data_ptr;
-        std::unique_ptr<std::map<std::string, Boxed_Value>> m_attrs;
+        /// shared between copies until one of them adds an attribute, see detail::get_shared_attr
+        std::shared_ptr<std::map<std::string, Boxed_Value>> m_attrs;
         bool m_is_ref;
+
+        /// True if the object lives in the Inline_Data this is, or in the one held by m_obj
+        bool m_is_inline;
       };
 
+      /// Data for a small scalar value, which is kept in m_inline rather than in m_obj.
+      /// Only these Data pay for the extra storage. m_inline is never overwritten after it is
+      /// set, so pointers into it stay valid for as long as the Data is alive, even once the
+      /// Boxed_Value has been assigned something else.
+      struct Inline_Data : Data
+      {
+        template<typename T>
+          Inline_Data(const Type_Info &ti, const T &t)
+            : Data(ti, chaiscript::detail::Any(), false, nullptr)
+          {
+            void *p = &m_inline;
+            new (p) T(t);
+            m_const_data_ptr = p;
+            m_data_ptr = m_type_info.is_const()?nullptr:p;
+            m_is_inline = true;
+          }
+
+        Inline_Storage m_inline;
+      };
+
+      /// Small scalar values are copied into Inline_Data::m_inline instead of being held by a
+      /// std::shared_ptr, saving two allocations per value
+      template<typename T>
+        struct Is_Inline : std::integral_constant<bool,
+          std::is_scalar<T>::value
+          && sizeof(T) <= sizeof(Inline_Storage)
+          && std::alignment_of<T>::value <= std::alignment_of<Inline_Storage>::value>
+        {
+        };
+
       struct Object_Data
       {
         static std::shared_ptr<Data> get(Boxed_Value::Void_Type)
@@ -144,6 +209,18 @@ namespace chaiscript
 
         template<typename T>
           static std::shared_ptr<Data> get(T t)
+          {
+            return get_value(std::move(t), detail::Get_Type_Info<T>::get(), Is_Inline<T>());
+          }
+
+        template<typename T>
+          static std::shared_ptr<Data> get_value(const T &t, const Type_Info &t_ti, std::true_type)
+          {
+            return std::make_shared<Inline_Data>(t_ti, t);
+          }
+
+        template<typename T>
+          static std::shared_ptr<Data> get_value(T t, const Type_Info &, std::false_type)
           {
             auto p = std::make_shared<T>(std::move(t));
             auto ptr = p.get();
@@ -167,6 +244,35 @@ namespace chaiscript
 
       };
 
+      struct Data_Tag
+      {
+      };
+
+      Boxed_Value(std::shared_ptr<Data> t_data, Data_Tag)
+        : m_data(std::move(t_data))
+      {
+      }
+
+      /// \returns the Data holding the storage of an inline value
+      std::shared_ptr<Data> inline_owner() const
+      {
+        if (m_data->m_obj.empty())
+        {
+          return m_data;
+        } else {
+          return m_data->m_obj.cast<std::shared_ptr<Data> >();
+        }
+      }
+
+      /// \returns true if the object is stored inline as a T
+      template<typename T>
+        bool holds_inline() const CHAISCRIPT_NOEXCEPT
+        {
+          return m_data->m_is_inline
+            && m_data->m_type_info.bare_equal_type_info(typeid(typename std::remove_const<T>::type))
+            && (std::is_const<T>::value || !m_data->m_type_info.is_const());
+        }
+
     public:
       /// Basic Boxed_Value constructor
         template<typename T,
@@ -195,11 +301,32 @@ namespace chaiscript
         std::swap(m_data, rhs.m_data);
       }
 
+      /// Creates an immutable Boxed_Value holding a copy of t, see chaiscript::const_var
+      template<typename T>
+        static Boxed_Value const_copy(const T &t)
+        {
+          return const_copy(t, Is_Inline<T>());
+        }
+
       /// Copy the values stored in rhs.m_data to m_data.
       /// m_data pointers are not shared in this case
       Boxed_Value assign(const Boxed_Value &rhs)
       {
         (*m_data) = (*rhs.m_data);
+
+        if (rhs.m_data->m_is_inline)
+        {
+          // share the inline value by keeping the Data that stores it alive, 
+          // as a held std::shared_ptr would be shared
+          const auto owner = rhs.inline_owner();
+          if (owner == m_data)
+          {
+            m_data->m_obj = chaiscript::detail::Any();
+          } else {
+            m_data->m_obj = chaiscript::detail::Any(owner);
+          }
+        }
+
         return *this;
       }
 
@@ -244,6 +371,37 @@ namespace chaiscript
         return !is_ref();
       }
 
+      /// \returns the std::shared_ptr<T> that owns an object held by value. An inline
+      ///          value is returned through a pointer sharing ownership of the Data storing it.
+      /// \throws chaiscript::detail::exception::bad_any_cast if the object is not held as a T
+      template<typename T>
+        std::shared_ptr<T> get_shared_ptr() const
+        {
+          if (m_data->m_is_inline)
+          {
+            return std::shared_ptr<T>(inline_owner(), get_value_ptr<T>());
+          } else {
+            return m_data->m_obj.cast<std::shared_ptr<T> >();
+          }
+        }
+
+      /// \returns a pointer to an object held by value, see get_shared_ptr()
+      /// \throws chaiscript::detail::exception::bad_any_cast if the object is not held as a T
+      template<typename T>
+        T *get_value_ptr() const
+        {
+          if (m_data->m_is_inline)
+          {
+            if (!holds_inline<T>())
+            {
+              throw chaiscript::detail::exception::bad_any_cast();
+            }
+            return static_cast<T *>(const_cast<void *>(m_data->m_const_data_ptr));
+          } else {
+            return m_data->m_obj.cast<std::shared_ptr<T> >().get();
+          }
+        }
+
       void *get_ptr() const CHAISCRIPT_NOEXCEPT
       {
         return m_data->m_data_ptr;
@@ -256,19 +414,21 @@ namespace chaiscript
 
       Boxed_Value get_attr(const std::string &t_name)
       {
-        if (!m_data->m_attrs)
-        {
-          m_data->m_attrs = std::unique_ptr<std::map<std::string, Boxed_Value>>(new std::map<std::string, Boxed_Value>());
-        }
+        return detail::get_shared_attr(m_data->m_attrs, t_name);
+      }
 
-        return (*m_data->m_attrs)[t_name];
+      /// \returns the attributes without copying them, or nullptr if none have been set.
+      ///          The map is never modified once shared; adding an attribute to this object copies it.
+      std::shared_ptr<const std::map<std::string, Boxed_Value>> get_shared_attrs() const
+      {
+        return m_data->m_attrs;
       }
 
       Boxed_Value &copy_attrs(const Boxed_Value &t_obj)
       {
         if (t_obj.m_data->m_attrs)
         {
-          m_data->m_attrs = std::unique_ptr<std::map<std::string, Boxed_Value>>(new std::map<std::string, Boxed_Value>(*t_obj.m_data->m_attrs));
+          m_data->m_attrs = t_obj.m_data->m_attrs;
         }
         return *this;
       }
@@ -281,6 +441,18 @@ namespace chaiscript
       }
 
     private:
+      template<typename T>
+        static Boxed_Value const_copy(const T &t, std::true_type)
+        {
+          return Boxed_Value(Object_Data::get_value(t, detail::Get_Type_Info<typename std::add_const<T>::type>::get(), std::true_type()), Data_Tag());
+        }
+
+      template<typename T>
+        static Boxed_Value const_copy(const T &t, std::false_type)
+        {
+          return Boxed_Value(std::make_shared<typename std::add_const<T>::type >(t));
+        }
+
       std::shared_ptr<Data> m_data;
   };
 
@@ -312,7 +484,7 @@ namespace chaiscript
     template<typename T>
       Boxed_Value const_var_impl(const T &t)
       {
-        return Boxed_Value(std::make_shared<typename std::add_const<T>::type >(t));
+        return Boxed_Value::const_copy(t);
       }
 
     /// \brief Takes a pointer to a value, adds const to the pointed to type and returns an immutable Boxed_Value.
@@ -7,6 +7,7 @@
 #ifndef CHAISCRIPT_DYNAMIC_OBJECT_DETAIL_HPP_
 #define CHAISCRIPT_DYNAMIC_OBJECT_DETAIL_HPP_
 
+#include <array>
 #include <cassert>
 #include <map>
 #include <memory>
@@ -16,6 +17,7 @@
 #include <vector>
 
 #include "../chaiscript_defines.hpp"
+#include "../chaiscript_threading.hpp"
 #include "boxed_cast.hpp"
 #include "boxed_cast_helper.hpp"
 #include "boxed_value.hpp"
@@ -180,9 +182,10 @@ namespace chaiscript
         public:
           Dynamic_Object_Constructor(
               std::string t_type_name,
+              std::shared_ptr<Dynamic_Object_Shape> t_shape,
               const Proxy_Function &t_func)
             : Proxy_Function_Base(build_type_list(t_func->get_param_types()), t_func->get_arity() - 1),
-              m_type_name(std::move(t_type_name)), m_func(t_func)
+              m_type_name(std::move(t_type_name)), m_shape(std::move(t_shape)), m_func(t_func)
           {
             assert( (t_func->get_arity() > 0 || t_func->get_arity() < 0)
                 && "Programming error, Dynamic_Object_Function must have at least one parameter (this)");
@@ -216,7 +219,7 @@ namespace chaiscript
 
           virtual bool call_match(const std::vector<Boxed_Value> &vals, const Type_Conversions &t_conversions) const CHAISCRIPT_OVERRIDE
           {
-            std::vector<Boxed_Value> new_vals{Boxed_Value(Dynamic_Object(m_type_name))};
+            std::vector<Boxed_Value> new_vals{Boxed_Value(Dynamic_Object(m_type_name, m_shape))};
             new_vals.insert(new_vals.end(), vals.begin(), vals.end());
 
             return m_func->call_match(new_vals, t_conversions);
@@ -230,7 +233,7 @@ namespace chaiscript
         protected:
           virtual Boxed_Value do_call(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions) const CHAISCRIPT_OVERRIDE
           {
-            auto bv = var(Dynamic_Object(m_type_name));
+            auto bv = var(Dynamic_Object(m_type_name, m_shape));
             std::vector<Boxed_Value> new_params{bv};
             new_params.insert(new_params.end(), params.begin(), params.end());
 
@@ -241,9 +244,175 @@ namespace chaiscript
 
         private:
           std::string m_type_name;
+          std::shared_ptr<Dynamic_Object_Shape> m_shape;
           Proxy_Function m_func;
 
       };
+
+
+      /**
+       * A Proxy_Function implementation that returns an attribute of a
+       * Dynamic_Object. The attribute's slot is looked up once, in the
+       * shape of the class the attribute is declared in, so reading it
+       * from an object of that class does not compare any strings.
+       * Registered wrapped in a Dynamic_Object_Function, which checks the class.
+       */
+      class Dynamic_Object_Attribute : public Proxy_Function_Base
+      {
+        public:
+          /// \param[in] t_shape the shape of the class the attribute is declared in
+          Dynamic_Object_Attribute(
+              std::string t_attr_name,
+              std::shared_ptr<Dynamic_Object_Shape> t_shape)
+            : Proxy_Function_Base({chaiscript::detail::Get_Type_Info<Boxed_Value>::get(),
+                  chaiscript::detail::Get_Type_Info<Dynamic_Object &>::get()}, 1),
+              m_attr_name(std::move(t_attr_name)), m_shape(std::move(t_shape)),
+              m_slot(m_shape->declare(m_attr_name)), m_doti(user_type<Dynamic_Object>())
+          {
+          }
+
+          virtual ~Dynamic_Object_Attribute() {}
+
+          virtual bool operator==(const Proxy_Function_Base &f) const CHAISCRIPT_OVERRIDE
+          {
+            const Dynamic_Object_Attribute *da = dynamic_cast<const Dynamic_Object_Attribute*>(&f);
+            return da && da->m_shape == m_shape && da->m_attr_name == m_attr_name;
+          }
+
+          virtual bool call_match(const std::vector<Boxed_Value> &vals, const Type_Conversions &) const CHAISCRIPT_OVERRIDE
+          {
+            return vals.size() == 1 && vals[0].get_type_info().bare_equal(m_doti) && !vals[0].is_const();
+          }
+
+          virtual std::string annotation() const CHAISCRIPT_OVERRIDE
+          {
+            return "";
+          }
+
+          const Dynamic_Object_Shape &get_shape() const
+          {
+            return *m_shape;
+          }
+
+          size_t get_slot() const
+          {
+            return m_slot;
+          }
+
+          Boxed_Value get_attr(Dynamic_Object &t_obj) const
+          {
+            return t_obj.get_attr_in_slot(*m_shape, m_slot, m_attr_name);
+          }
+
+        protected:
+          virtual Boxed_Value do_call(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions) const CHAISCRIPT_OVERRIDE
+          {
+            if (params.size() != 1)
+            {
+              throw exception::arity_error(static_cast<int>(params.size()), 1);
+            }
+
+            return get_attr(boxed_cast<Dynamic_Object &>(params[0], &t_conversions));
+          }
+
+        private:
+          std::string m_attr_name;
+          std::shared_ptr<Dynamic_Object_Shape> m_shape;
+          size_t m_slot;
+          const Type_Info m_doti;
+      };
+
+
+      /**
+       * Inline cache kept by an attribute access in a script. For each site and
+       * shape of object seen it remembers the slot that dispatch ended up reading,
+       * so later reads of an object with that shape go straight to the slot.
+       *
+       * Entries are tagged with a generation number provided by the caller, any
+       * change in the set of registered functions must change that number.
+       * Lookups read a published snapshot of the entries without taking a lock.
+       */
+      class Attribute_Cache
+      {
+        public:
+          Attribute_Cache()
+            : m_entries(std::make_shared<const Entries>())
+          {
+          }
+
+          Attribute_Cache(const Attribute_Cache &) = delete;
+          Attribute_Cache &operator=(const Attribute_Cache &) = delete;
+
+          /// \returns true, setting t_attr, if the attribute of t_obj read at t_site is cached
+          bool find(const void *t_site, size_t t_generation, Dynamic_Object &t_obj, Boxed_Value &t_attr) const
+          {
+            const auto entries = std::atomic_load(&m_entries);
+
+            for (const auto &entry : entries->entries)
+            {
+              if (entry.site == t_site && entry.generation == t_generation && entry.shape == t_obj.get_shape().get())
+              {
+                t_attr = t_obj.get_slot(entry.slot);
+                return true;
+              }
+            }
+
+            return false;
+          }
+
+          /// Remember that reading at t_site from objects shaped like t_obj is done by t_attr,
+          /// replacing the oldest entry. Nothing is remembered if t_attr belongs to another shape.
+          void insert(const void *t_site, size_t t_generation, const Dynamic_Object &t_obj, const Dynamic_Object_Attribute &t_attr)
+          {
+            if (&t_attr.get_shape() != t_obj.get_shape().get()) {
+              return;
+            }
+
+            chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::mutex> l(m_mutex);
+
+            auto entries = std::make_shared<Entries>(*m_entries);
+
+            Entry &entry = entries->entries[entries->next];
+            entries->next = (entries->next + 1) % entries->entries.size();
+
+            entry.site = t_site;
+            entry.generation = t_generation;
+            entry.shape = t_obj.get_shape().get();
+            entry.slot = t_attr.get_slot();
+
+            std::atomic_store(&m_entries, std::shared_ptr<const Entries>(std::move(entries)));
+          }
+
+        private:
+          struct Entry
+          {
+            Entry()
+              : site(nullptr), generation(0), shape(nullptr), slot(0)
+            {
+            }
+
+            const void *site;
+            size_t generation;
+            const Dynamic_Object_Shape *shape;
+            size_t slot;
+          };
+
+          struct Entries
+          {
+            Entries()
+              : next(0)
+            {
+            }
+
+            std::array<Entry, 4> entries;
+            size_t next;
+          };
+
+          /// serializes the writers, readers only load m_entries
+          chaiscript::detail::threading::mutex m_mutex;
+          /// replaced, never modified, by a writer; only accessed through std::atomic_load and std::atomic_store
+          std::shared_ptr<const Entries> m_entries;
+      };
     }
   }
 }
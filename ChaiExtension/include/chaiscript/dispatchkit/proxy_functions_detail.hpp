@@ -79,6 +79,12 @@ namespace chaiscript
             boxed_cast<Param>(params[generation], &t_conversions);
             Try_Cast<Rest...>::do_try(params, generation+1, t_conversions);
           }
+
+          static bool can_cast(const std::vector<Boxed_Value> &params, size_t generation, const Type_Conversions &t_conversions)
+          {
+            return can_boxed_cast<Param>(params[generation], &t_conversions)
+              && Try_Cast<Rest...>::can_cast(params, generation+1, t_conversions);
+          }
         };
 
       // 0th case
@@ -88,8 +94,25 @@ namespace chaiscript
           static void do_try(const std::vector<Boxed_Value> &, size_t, const Type_Conversions &)
           {
           }
+
+          static bool can_cast(const std::vector<Boxed_Value> &, size_t, const Type_Conversions &)
+          {
+            return true;
+          }
         };
 
+      /**
+       * Used by Proxy_Function_Impl to reject, without throwing, parameters
+       * that cannot possibly be cast to the function's parameter types
+       */
+      template<typename Ret, typename ... Params>
+        bool can_cast_params(Ret (*)(Params...),
+             const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions)
+        {
+          return params.size() == sizeof...(Params) 
+            && Try_Cast<Params...>::can_cast(params, 0, t_conversions);
+        }
+
 
       /**
        * Used by Proxy_Function_Impl to determine if it is equivalent to another
@@ -100,6 +123,11 @@ namespace chaiscript
         bool compare_types_cast(Ret (*)(Params...),
              const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions)
        {
+          if (!Try_Cast<Params...>::can_cast(params, 0, t_conversions))
+          {
+            return false;
+          }
+
           try {
             Try_Cast<Params...>::do_try(params, 0, t_conversions);
           } catch (const exception::bad_boxed_cast &) {
@@ -0,0 +1,251 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2015, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+#ifndef CHAISCRIPT_SYMBOL_HPP_
+#define CHAISCRIPT_SYMBOL_HPP_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../chaiscript_threading.hpp"
+
+namespace chaiscript
+{
+  namespace detail
+  {
+    /// \brief An interned name
+    ///
+    /// Every distinct name is given a small id, shared by all engines, the first time it is
+    /// interned. Symbols compare by id, so the name tables of the Dispatch_Engine can be keyed
+    /// by it instead of by string. Interning takes a lock and hashes the name, so it is done
+    /// once, when the AST is built or a name is registered, rather than on each lookup.
+    /// Each distinct name is kept once for the life of the process, since parsed code may hold
+    /// its symbols without holding an engine.
+    class Symbol
+    {
+      public:
+        static const uint32_t invalid_id = 0xFFFFFFFF;
+
+        /// An invalid symbol, which no name maps to
+        Symbol()
+          : m_id(invalid_id), m_name(&empty_name())
+        {
+        }
+
+        /// Interns t_name
+        explicit Symbol(const std::string &t_name)
+          : Symbol(table().intern(t_name))
+        {
+        }
+
+        /// \returns The symbol of t_name if it has been interned, otherwise an invalid symbol.
+        ///          Use this for lookups, since a name that was never interned cannot be registered.
+        static Symbol find(const std::string &t_name)
+        {
+          return table().find(t_name);
+        }
+
+        uint32_t id() const
+        {
+          return m_id;
+        }
+
+        bool is_valid() const
+        {
+          return m_id != invalid_id;
+        }
+
+        const std::string &name() const
+        {
+          return *m_name;
+        }
+
+        bool operator==(const Symbol &t_rhs) const
+        {
+          return m_id == t_rhs.m_id;
+        }
+
+        bool operator!=(const Symbol &t_rhs) const
+        {
+          return m_id != t_rhs.m_id;
+        }
+
+        bool operator<(const Symbol &t_rhs) const
+        {
+          return m_id < t_rhs.m_id;
+        }
+
+      private:
+        Symbol(uint32_t t_id, const std::string *t_name)
+          : m_id(t_id), m_name(t_name)
+        {
+        }
+
+        class Table
+        {
+          public:
+            Symbol intern(const std::string &t_name)
+            {
+              chaiscript::detail::threading::lock_guard<chaiscript::detail::threading::mutex> l(m_mutex);
+
+              // elements of an unordered_map stay put when it rehashes, so a symbol can
+              // keep a pointer to its name
+              const auto itr = m_ids.insert(std::make_pair(t_name, static_cast<uint32_t>(m_ids.size()))).first;
+              return Symbol(itr->second, &itr->first);
+            }
+
+            Symbol find(const std::string &t_name) const
+            {
+              chaiscript::detail::threading::lock_guard<chaiscript::detail::threading::mutex> l(m_mutex);
+
+              const auto itr = m_ids.find(t_name);
+              if (itr != m_ids.end()) {
+                return Symbol(itr->second, &itr->first);
+              } else {
+                return Symbol();
+              }
+            }
+
+          private:
+            std::unordered_map<std::string, uint32_t> m_ids;
+            mutable chaiscript::detail::threading::mutex m_mutex;
+        };
+
+        static Table &table()
+        {
+          static Table t;
+          return t;
+        }
+
+        static const std::string &empty_name()
+        {
+          static const std::string name;
+          return name;
+        }
+
+        uint32_t m_id;
+        const std::string *m_name;
+    };
+
+    /// \returns The symbols of t_names, in the same order
+    inline std::vector<Symbol> to_symbols(const std::vector<std::string> &t_names)
+    {
+      std::vector<Symbol> symbols;
+      symbols.reserve(t_names.size());
+      for (const auto &name : t_names)
+      {
+        symbols.push_back(Symbol(name));
+      }
+      return symbols;
+    }
+
+    /// \brief Table from symbol to T, stored as an open addressed hash table keyed by symbol id
+    ///
+    /// Lookups hash the id and probe a flat array. The array is sized by the number of
+    /// symbols stored in the table, not by the largest id, so a table holding a few names
+    /// stays small however many names the process has interned.
+    template<typename T>
+      class Symbol_Index
+      {
+        public:
+          Symbol_Index()
+            : m_size(0), m_shift(64)
+          {
+          }
+
+          /// \returns The value stored for t_symbol, or null if there is none
+          const T *find(const Symbol &t_symbol) const
+          {
+            if (m_entries.empty()) {
+              return nullptr;
+            }
+
+            const size_t mask = m_entries.size() - 1;
+            for (size_t i = slot(t_symbol.id(), m_shift); m_entries[i].first != Symbol::invalid_id; i = (i + 1) & mask)
+            {
+              if (m_entries[i].first == t_symbol.id()) {
+                return &m_entries[i].second;
+              }
+            }
+
+            return nullptr;
+          }
+
+          void set(const Symbol &t_symbol, const T &t_t)
+          {
+            if ((m_size + 1) * 2 > m_entries.size()) {
+              grow();
+            }
+
+            if (insert(m_entries, m_shift, t_symbol.id(), t_t)) {
+              ++m_size;
+            }
+          }
+
+          /// Removes every value, keeping the array for the values stored next
+          void clear()
+          {
+            if (m_size != 0) {
+              for (auto &entry : m_entries)
+              {
+                entry = std::make_pair(uint32_t(Symbol::invalid_id), T());
+              }
+              m_size = 0;
+            }
+          }
+
+        private:
+          typedef std::vector<std::pair<uint32_t, T>> Entries;
+
+          /// Fibonacci hashing: the top bits of the product depend on every bit of the id, so
+          /// ids handed out in order, or a stride apart, land on well spread slots
+          /// \param[in] t_shift 64 less the number of bits of a slot index
+          static size_t slot(uint32_t t_id, unsigned t_shift)
+          {
+            return static_cast<size_t>((static_cast<uint64_t>(t_id) * 0x9E3779B97F4A7C15ull) >> t_shift);
+          }
+
+          /// \returns true if t_id was not in t_entries yet
+          static bool insert(Entries &t_entries, unsigned t_shift, uint32_t t_id, const T &t_t)
+          {
+            const size_t mask = t_entries.size() - 1;
+            size_t i = slot(t_id, t_shift);
+            while (t_entries[i].first != Symbol::invalid_id && t_entries[i].first != t_id)
+            {
+              i = (i + 1) & mask;
+            }
+
+            const bool added = t_entries[i].first == Symbol::invalid_id;
+            t_entries[i] = std::make_pair(t_id, t_t);
+            return added;
+          }
+
+          void grow()
+          {
+            Entries entries(m_entries.empty() ? 8 : m_entries.size() * 2, std::make_pair(uint32_t(Symbol::invalid_id), T()));
+            const unsigned shift = m_entries.empty() ? 61 : m_shift - 1;
+            for (const auto &entry : m_entries)
+            {
+              if (entry.first != Symbol::invalid_id) {
+                insert(entries, shift, entry.first, entry.second);
+              }
+            }
+            m_entries.swap(entries);
+            m_shift = shift;
+          }
+
+          Entries m_entries;
+          size_t m_size;
+          /// 64 less log2 of the size of m_entries
+          unsigned m_shift;
+      };
+  }
+}
+
+#endif
@@ -7,7 +7,9 @@
 #ifndef CHAISCRIPT_DYNAMIC_CAST_CONVERSION_HPP_
 #define CHAISCRIPT_DYNAMIC_CAST_CONVERSION_HPP_
 
+#include <algorithm>
 #include <atomic>
+#include <iterator>
 #include <memory>
 #include <set>
 #include <stdexcept>
@@ -221,6 +223,7 @@ namespace chaiscript
           m_conversions(),
           m_convertableTypes(),
           m_num_types(0),
+          m_num_conversions(0),
           m_thread_cache(this),
           m_conversion_saves(this)
       {
@@ -231,6 +234,7 @@ namespace chaiscript
           m_conversions(t_other.get_conversions()),
           m_convertableTypes(),
           m_num_types(m_conversions.size()),
+          m_num_conversions(m_conversions.size()),
           m_thread_cache(this),
           m_conversion_saves(this)
 
@@ -256,6 +260,13 @@ namespace chaiscript
         m_conversions.insert(conversion);
         m_convertableTypes.insert({conversion->to().bare_type_info(), conversion->from().bare_type_info()});
         m_num_types = m_convertableTypes.size();
+        ++m_num_conversions;
+      }
+
+      /// \returns the number of conversions that have been added, never decreases
+      size_t num_conversions() const
+      {
+        return m_num_conversions;
       }
 
       template<typename T>
@@ -322,6 +333,15 @@ namespace chaiscript
         return ret;
       }
 
+      /// Moves the saved conversion results onto the end of t_saves, keeping the
+      /// capacity of this thread's save buffer for the next call
+      void take_saves(std::vector<Boxed_Value> &t_saves)
+      {
+        auto &saves = m_conversion_saves->saves;
+        std::move(saves.begin(), saves.end(), std::back_inserter(t_saves));
+        saves.clear();
+      }
+
       bool has_conversion(const Type_Info &to, const Type_Info &from) const
       {
         chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
@@ -376,6 +396,7 @@ namespace chaiscript
       std::set<std::shared_ptr<detail::Type_Conversion_Base>> m_conversions;
       std::set<const std::type_info *, Less_Than> m_convertableTypes;
       std::atomic_size_t m_num_types;
+      std::atomic_size_t m_num_conversions;
       mutable chaiscript::detail::threading::Thread_Storage<std::set<const std::type_info *, Less_Than>> m_thread_cache;
       mutable chaiscript::detail::threading::Thread_Storage<Conversion_Saves> m_conversion_saves;
   };
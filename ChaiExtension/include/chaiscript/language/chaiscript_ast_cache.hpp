@@ -0,0 +1,692 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2015, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+#ifndef CHAISCRIPT_AST_CACHE_HPP_
+#define CHAISCRIPT_AST_CACHE_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include <sys/stat.h>
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__) || defined(__HAIKU__)
+#include <unistd.h>
+#endif
+
+#if defined(_POSIX_VERSION)
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "../chaiscript_threading.hpp"
+#include "../dispatchkit/boxed_value.hpp"
+#include "../dispatchkit/dispatchkit.hpp"
+#include "chaiscript_algebraic.hpp"
+#include "chaiscript_common.hpp"
+#include "chaiscript_eval.hpp"
+
+namespace chaiscript
+{
+  /// \brief Classes and functions used to keep parsed scripts on disk between runs
+  namespace cache
+  {
+    namespace detail
+    {
+      /// 64 bit FNV-1a, used to name cache files and to notice edited sources
+      inline uint64_t hash(const std::string &t_str)
+      {
+        uint64_t h = 14695981039346656037ULL;
+        for (const char c : t_str)
+        {
+          h ^= static_cast<unsigned char>(c);
+          h *= 1099511628211ULL;
+        }
+        return h;
+      }
+
+      /// Modification time of t_path, or 0 if it is not a file on disk
+      inline int64_t modification_time(const std::string &t_path)
+      {
+        struct stat st;
+        if (stat(t_path.c_str(), &st) == 0) {
+          return static_cast<int64_t>(st.st_mtime);
+        } else {
+          return 0;
+        }
+      }
+
+      /// Appends the fields of a cache file to a buffer, in the byte order of this machine
+      class Writer
+      {
+        public:
+          template<typename T>
+            void write(const T &t_t)
+            {
+              m_data.append(reinterpret_cast<const char *>(&t_t), sizeof(T));
+            }
+
+          void write(const std::string &t_str)
+          {
+            write(static_cast<uint32_t>(t_str.size()));
+            m_data.append(t_str);
+          }
+
+          const std::string &data() const
+          {
+            return m_data;
+          }
+
+        private:
+          std::string m_data;
+      };
+
+      /// Reads back what a Writer produced, throwing if the data ends early
+      class Reader
+      {
+        public:
+          explicit Reader(const std::string &t_data)
+            : m_data(t_data.data()), m_size(t_data.size()), m_pos(0)
+          {
+          }
+
+          Reader(const char *t_data, size_t t_size)
+            : m_data(t_data), m_size(t_size), m_pos(0)
+          {
+          }
+
+          template<typename T>
+            T read()
+            {
+              require(sizeof(T));
+              T t;
+              std::memcpy(&t, m_data + m_pos, sizeof(T));
+              m_pos += sizeof(T);
+              return t;
+            }
+
+          std::string read_string()
+          {
+            const size_t size = read<uint32_t>();
+            require(size);
+            std::string str(m_data + m_pos, size);
+            m_pos += size;
+            return str;
+          }
+
+          bool at_end() const
+          {
+            return m_pos == m_size;
+          }
+
+        private:
+          void require(size_t t_size) const
+          {
+            if (m_size - m_pos < t_size) {
+              throw std::runtime_error("Truncated AST cache file");
+            }
+          }
+
+          const char *m_data;
+          size_t m_size;
+          size_t m_pos;
+      };
+
+      /// \brief Read only view of a whole file
+      ///
+      /// Where the platform has mmap the file is mapped rather than read, so it is paged in as
+      /// it is used and never copied onto the heap. Elsewhere it is read into memory.
+      class Mapped_File
+      {
+        public:
+          explicit Mapped_File(const std::string &t_path)
+            : m_data(nullptr), m_size(0)
+          {
+#if defined(_POSIX_VERSION)
+            const int fd = open(t_path.c_str(), O_RDONLY);
+            if (fd < 0) {
+              return;
+            }
+
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0) {
+              void *map = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+              if (map != MAP_FAILED) {
+                m_data = static_cast<const char *>(map);
+                m_size = static_cast<size_t>(st.st_size);
+              }
+            }
+            close(fd);
+#else
+            std::ifstream infile(t_path.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+            if (!infile.is_open()) {
+              return;
+            }
+
+            const std::streamoff size = infile.tellg();
+            if (size <= 0) {
+              return;
+            }
+
+            m_contents.resize(static_cast<size_t>(size));
+            infile.seekg(0, std::ios::beg);
+            if (infile.read(&m_contents[0], size)) {
+              m_data = m_contents.data();
+              m_size = m_contents.size();
+            }
+#endif
+          }
+
+          ~Mapped_File()
+          {
+#if defined(_POSIX_VERSION)
+            if (m_data) {
+              munmap(const_cast<char *>(m_data), m_size);
+            }
+#endif
+          }
+
+          Mapped_File(const Mapped_File &) = delete;
+          Mapped_File &operator=(const Mapped_File &) = delete;
+
+          /// \returns The contents of the file, or null if it could not be read or is empty
+          const char *data() const
+          {
+            return m_data;
+          }
+
+          size_t size() const
+          {
+            return m_size;
+          }
+
+        private:
+          const char *m_data;
+          size_t m_size;
+#if !defined(_POSIX_VERSION)
+          std::string m_contents;
+#endif
+      };
+
+      /// Thrown while storing a tree holding a node the cache does not know how to rebuild
+      struct uncacheable : std::runtime_error
+      {
+        uncacheable() : std::runtime_error("AST cannot be cached") { }
+      };
+
+      /// \brief Converts a parsed AST to and from the binary cache format
+      ///
+      /// A node is written as its identifier, the node class used for it when that is not
+      /// the usual one, its text, filename and position, the literal value of Int and
+      /// Float nodes, the operator of Prefix nodes, then its children and annotation.
+      class Serializer
+      {
+        public:
+          explicit Serializer(chaiscript::detail::Dispatch_Engine &t_engine)
+            : m_engine(t_engine)
+          {
+          }
+
+          /// \throws uncacheable if a node in the tree cannot be rebuilt exactly
+          void write(Writer &t_out, const AST_NodePtr &t_node, const std::shared_ptr<std::string> &t_filename) const
+          {
+            const uint8_t variant = variant_of(t_node);
+            Boxed_Value value = m_no_value;
+            Operators::Opers oper = Operators::invalid;
+
+            if (t_node->identifier == AST_Node_Type::Int || t_node->identifier == AST_Node_Type::Float) {
+              value = t_node->eval(m_engine);
+            } else if (t_node->identifier == AST_Node_Type::Prefix) {
+              const auto prefix = dynamic_cast<const eval::Prefix_AST_Node *>(t_node.get());
+              if (!prefix) {
+                throw uncacheable();
+              }
+              oper = prefix->get_oper();
+            }
+
+            // making a node of the class we would read back is the only way to be sure
+            // the cache reproduces this one
+            const AST_NodePtr rebuilt = make_node(t_node->identifier, variant, t_node->text, value, oper, t_filename);
+            if (!rebuilt || typeid(*rebuilt) != typeid(*t_node)) {
+              throw uncacheable();
+            }
+
+            t_out.write(static_cast<int32_t>(t_node->identifier));
+            t_out.write(variant);
+            t_out.write(t_node->text);
+
+            if (!t_node->filename) {
+              t_out.write(uint8_t(0));
+            } else if (t_filename && *t_node->filename == *t_filename) {
+              t_out.write(uint8_t(1));
+            } else {
+              t_out.write(uint8_t(2));
+              t_out.write(*t_node->filename);
+            }
+
+            t_out.write(static_cast<int32_t>(t_node->start.line));
+            t_out.write(static_cast<int32_t>(t_node->start.column));
+            t_out.write(static_cast<int32_t>(t_node->end.line));
+            t_out.write(static_cast<int32_t>(t_node->end.column));
+
+            if (t_node->identifier == AST_Node_Type::Int || t_node->identifier == AST_Node_Type::Float) {
+              write_value(t_out, value);
+            } else if (t_node->identifier == AST_Node_Type::Prefix) {
+              t_out.write(static_cast<int32_t>(oper));
+            }
+
+            t_out.write(static_cast<uint32_t>(t_node->children.size()));
+            for (const auto &child : t_node->children)
+            {
+              write(t_out, child, t_filename);
+            }
+
+            t_out.write(uint8_t(t_node->annotation ? 1 : 0));
+            if (t_node->annotation) {
+              write(t_out, t_node->annotation, t_filename);
+            }
+          }
+
+          AST_NodePtr read(Reader &t_in, const std::shared_ptr<std::string> &t_filename) const
+          {
+            const int identifier = t_in.read<int32_t>();
+            const uint8_t variant = t_in.read<uint8_t>();
+            const std::string text = t_in.read_string();
+
+            std::shared_ptr<std::string> filename;
+            switch (t_in.read<uint8_t>())
+            {
+              case 0:
+                break;
+              case 1:
+                filename = t_filename;
+                break;
+              default:
+                filename = std::make_shared<std::string>(t_in.read_string());
+            }
+
+            const int start_line = t_in.read<int32_t>();
+            const int start_col = t_in.read<int32_t>();
+            const int end_line = t_in.read<int32_t>();
+            const int end_col = t_in.read<int32_t>();
+
+            Boxed_Value value = m_no_value;
+            Operators::Opers oper = Operators::invalid;
+            if (identifier == AST_Node_Type::Int || identifier == AST_Node_Type::Float) {
+              value = read_value(t_in);
+            } else if (identifier == AST_Node_Type::Prefix) {
+              oper = static_cast<Operators::Opers>(t_in.read<int32_t>());
+            }
+
+            AST_NodePtr node = make_node(identifier, variant, text, value, oper, filename);
+            if (!node) {
+              throw std::runtime_error("Unknown node in AST cache file");
+            }
+
+            node->filename = filename;
+            node->start = File_Position(start_line, start_col);
+            node->end = File_Position(end_line, end_col);
+
+            const size_t num_children = t_in.read<uint32_t>();
+            node->children.reserve(num_children);
+            for (size_t i = 0; i < num_children; ++i)
+            {
+              node->children.push_back(read(t_in, t_filename));
+            }
+
+            if (t_in.read<uint8_t>() != 0) {
+              node->annotation = read(t_in, t_filename);
+            }
+
+            return node;
+          }
+
+        private:
+          /// Nodes whose class is not the one normally used for their identifier
+          enum Variant { Usual, Ternary, Lambda_Class, Reference_Class };
+
+          /// Literal value types an Int or Float node may hold
+          enum Value_Type { Int, Unsigned, Long, Unsigned_Long, Long_Long, Unsigned_Long_Long, Double, Float, Long_Double };
+
+          static uint8_t variant_of(const AST_NodePtr &t_node)
+          {
+            const std::type_info &type = typeid(*t_node);
+            if (type == typeid(eval::Ternary_Cond_AST_Node)) {
+              return Ternary;
+            } else if (type == typeid(eval::Lambda_AST_Node) && t_node->identifier != AST_Node_Type::Lambda) {
+              return Lambda_Class;
+            } else if (type == typeid(eval::Reference_AST_Node) && t_node->identifier != AST_Node_Type::Reference) {
+              return Reference_Class;
+            } else {
+              return Usual;
+            }
+          }
+
+          template<typename T>
+            static bool write_value_as(Writer &t_out, const Boxed_Value &t_value, Value_Type t_type)
+            {
+              if (!t_value.get_type_info().bare_equal(user_type<T>())) {
+                return false;
+              }
+
+              t_out.write(static_cast<uint8_t>(t_type));
+              t_out.write(uint8_t(t_value.is_const() ? 1 : 0));
+              const T t = boxed_cast<T>(t_value);
+              t_out.write(t);
+              return true;
+            }
+
+          static void write_value(Writer &t_out, const Boxed_Value &t_value)
+          {
+            if (!(write_value_as<int>(t_out, t_value, Int)
+                  || write_value_as<unsigned int>(t_out, t_value, Unsigned)
+                  || write_value_as<long>(t_out, t_value, Long)
+                  || write_value_as<unsigned long>(t_out, t_value, Unsigned_Long)
+                  || write_value_as<long long>(t_out, t_value, Long_Long)
+                  || write_value_as<unsigned long long>(t_out, t_value, Unsigned_Long_Long)
+                  || write_value_as<double>(t_out, t_value, Double)
+                  || write_value_as<float>(t_out, t_value, Float)
+                  || write_value_as<long double>(t_out, t_value, Long_Double)))
+            {
+              throw uncacheable();
+            }
+          }
+
+          template<typename T>
+            static Boxed_Value read_value_as(Reader &t_in, bool t_const)
+            {
+              const T t = t_in.read<T>();
+              return t_const ? const_var(t) : Boxed_Value(t);
+            }
+
+          static Boxed_Value read_value(Reader &t_in)
+          {
+            const uint8_t type = t_in.read<uint8_t>();
+            const bool is_const = t_in.read<uint8_t>() != 0;
+
+            switch (type)
+            {
+              case Int:
+                return read_value_as<int>(t_in, is_const);
+              case Unsigned:
+                return read_value_as<unsigned int>(t_in, is_const);
+              case Long:
+                return read_value_as<long>(t_in, is_const);
+              case Unsigned_Long:
+                return read_value_as<unsigned long>(t_in, is_const);
+              case Long_Long:
+                return read_value_as<long long>(t_in, is_const);
+              case Unsigned_Long_Long:
+                return read_value_as<unsigned long long>(t_in, is_const);
+              case Double:
+                return read_value_as<double>(t_in, is_const);
+              case Float:
+                return read_value_as<float>(t_in, is_const);
+              case Long_Double:
+                return read_value_as<long double>(t_in, is_const);
+              default:
+                throw std::runtime_error("Unknown literal type in AST cache file");
+            }
+          }
+
+          /// Constructs an empty node of the class the parser uses for t_identifier, or
+          /// a null pointer if there is none
+          static AST_NodePtr make_node(int t_identifier, uint8_t t_variant, const std::string &t_text,
+              const Boxed_Value &t_value, Operators::Opers t_oper, const std::shared_ptr<std::string> &t_filename)
+          {
+            if (t_variant == Ternary) {
+              return std::make_shared<eval::Ternary_Cond_AST_Node>(t_text);
+            } else if (t_variant == Lambda_Class) {
+              return std::make_shared<eval::Lambda_AST_Node>(t_text, t_identifier);
+            } else if (t_variant == Reference_Class) {
+              return std::make_shared<eval::Reference_AST_Node>(t_text, t_identifier);
+            }
+
+            switch (t_identifier)
+            {
+              case AST_Node_Type::Int:
+                return std::make_shared<eval::Int_AST_Node>(t_text, t_value, t_filename, 0, 0, 0, 0);
+              case AST_Node_Type::Float:
+                return std::make_shared<eval::Float_AST_Node>(t_text, t_value, t_filename, 0, 0, 0, 0);
+              case AST_Node_Type::Id:
+                return std::make_shared<eval::Id_AST_Node>(t_text, t_filename, 0, 0, 0, 0);
+              case AST_Node_Type::Char:
+                return std::make_shared<eval::Char_AST_Node>(t_text, t_filename, 0, 0, 0, 0);
+              case AST_Node_Type::Str:
+                return std::make_shared<eval::Str_AST_Node>(t_text, t_filename, 0, 0, 0, 0);
+              case AST_Node_Type::Eol:
+                return std::make_shared<eval::Eol_AST_Node>(t_text, t_filename, 0, 0, 0, 0);
+              case AST_Node_Type::Fun_Call:
+                return std::make_shared<eval::Fun_Call_AST_Node>(t_text);
+              case AST_Node_Type::Inplace_Fun_Call:
+                return std::make_shared<eval::Inplace_Fun_Call_AST_Node>(t_text);
+              case AST_Node_Type::Arg:
+                return std::make_shared<eval::Arg_AST_Node>(t_text);
+              case AST_Node_Type::Arg_List:
+                return std::make_shared<eval::Arg_List_AST_Node>(t_text);
+              case AST_Node_Type::Equation:
+                return std::make_shared<eval::Equation_AST_Node>(t_text);
+              case AST_Node_Type::Var_Decl:
+                return std::make_shared<eval::Var_Decl_AST_Node>(t_text);
+              case AST_Node_Type::Array_Call:
+                return std::make_shared<eval::Array_Call_AST_Node>(t_text);
+              case AST_Node_Type::Dot_Access:
+                return std::make_shared<eval::Dot_Access_AST_Node>(t_text);
+              case AST_Node_Type::Quoted_String:
+                return std::make_shared<eval::Quoted_String_AST_Node>(t_text);
+              case AST_Node_Type::Single_Quoted_String:
+                return std::make_shared<eval::Single_Quoted_String_AST_Node>(t_text);
+              case AST_Node_Type::Lambda:
+                return std::make_shared<eval::Lambda_AST_Node>(t_text);
+              case AST_Node_Type::Block:
+                return std::make_shared<eval::Block_AST_Node>(t_text);
+              case AST_Node_Type::Def:
+                return std::make_shared<eval::Def_AST_Node>(t_text);
+              case AST_Node_Type::While:
+                return std::make_shared<eval::While_AST_Node>(t_text);
+              case AST_Node_Type::Class:
+                return std::make_shared<eval::Class_AST_Node>(t_text);
+              case AST_Node_Type::If:
+                return std::make_shared<eval::If_AST_Node>(t_text);
+              case AST_Node_Type::For:
+                return std::make_shared<eval::For_AST_Node>(t_text);
+              case AST_Node_Type::Switch:
+                return std::make_shared<eval::Switch_AST_Node>(t_text);
+              case AST_Node_Type::Case:
+                return std::make_shared<eval::Case_AST_Node>(t_text);
+              case AST_Node_Type::Default:
+                return std::make_shared<eval::Default_AST_Node>(t_text);
+              case AST_Node_Type::Inline_Array:
+                return std::make_shared<eval::Inline_Array_AST_Node>(t_text);
+              case AST_Node_Type::Inline_Map:
+                return std::make_shared<eval::Inline_Map_AST_Node>(t_text);
+              case AST_Node_Type::Return:
+                return std::make_shared<eval::Return_AST_Node>(t_text);
+              case AST_Node_Type::File:
+                return std::make_shared<eval::File_AST_Node>(t_text);
+              case AST_Node_Type::Reference:
+                return std::make_shared<eval::Reference_AST_Node>(t_text);
+              case AST_Node_Type::Prefix:
+                return std::make_shared<eval::Prefix_AST_Node>(t_oper);
+              case AST_Node_Type::Break:
+                return std::make_shared<eval::Break_AST_Node>(t_text);
+              case AST_Node_Type::Continue:
+                return std::make_shared<eval::Continue_AST_Node>(t_text);
+              case AST_Node_Type::Noop:
+                return std::make_shared<eval::Noop_AST_Node>(t_text);
+              case AST_Node_Type::Map_Pair:
+                return std::make_shared<eval::Map_Pair_AST_Node>(t_text);
+              case AST_Node_Type::Value_Range:
+                return std::make_shared<eval::Value_Range_AST_Node>(t_text);
+              case AST_Node_Type::Inline_Range:
+                return std::make_shared<eval::Inline_Range_AST_Node>(t_text);
+              case AST_Node_Type::Annotation:
+                return std::make_shared<eval::Annotation_AST_Node>(t_text);
+              case AST_Node_Type::Try:
+                return std::make_shared<eval::Try_AST_Node>(t_text);
+              case AST_Node_Type::Catch:
+                return std::make_shared<eval::Catch_AST_Node>(t_text);
+              case AST_Node_Type::Finally:
+                return std::make_shared<eval::Finally_AST_Node>(t_text);
+              case AST_Node_Type::Method:
+                return std::make_shared<eval::Method_AST_Node>(t_text);
+              case AST_Node_Type::Attr_Decl:
+                return std::make_shared<eval::Attr_Decl_AST_Node>(t_text);
+              case AST_Node_Type::Logical_And:
+                return std::make_shared<eval::Logical_And_AST_Node>(t_text);
+              case AST_Node_Type::Logical_Or:
+                return std::make_shared<eval::Logical_Or_AST_Node>(t_text);
+              case AST_Node_Type::Binary:
+                return std::make_shared<eval::Binary_Operator_AST_Node>(t_text);
+              default:
+                return AST_NodePtr();
+            }
+          }
+
+          chaiscript::detail::Dispatch_Engine &m_engine;
+
+          /// Shared by the nodes without a literal value, a new undefined value is an allocation
+          const Boxed_Value m_no_value;
+      };
+    }
+
+    /// \brief Keeps the parsed AST of each evaluated file in a directory, so that later runs
+    ///        can skip parsing files that have not changed
+    ///
+    /// Each file gets one cache entry, named after a hash of its path. An entry is only used
+    /// if the path, modification time, size and content hash recorded in it all match the
+    /// source being evaluated; anything else, including a damaged entry, is a miss and the
+    /// source is parsed as usual. The format is specific to the machine that wrote it.
+    class AST_Cache
+    {
+      public:
+        /// \param[in] t_directory Where cache entries are kept, created if missing. Caching is
+        ///                        disabled if it is empty.
+        explicit AST_Cache(std::string t_directory = std::string())
+          : m_directory(std::move(t_directory))
+        {
+          if (!m_directory.empty()) {
+#ifdef _WIN32
+            _mkdir(m_directory.c_str());
+#else
+            mkdir(m_directory.c_str(), 0777);
+#endif
+          }
+        }
+
+        bool enabled() const
+        {
+          return !m_directory.empty();
+        }
+
+        /// \returns The cached AST for t_filename if it was stored from exactly t_input,
+        ///          otherwise a null pointer
+        AST_NodePtr load(chaiscript::detail::Dispatch_Engine &t_engine, const std::string &t_filename, const std::string &t_input) const
+        {
+          const detail::Mapped_File file(entry_path(t_filename));
+          if (!file.data()) {
+            return AST_NodePtr();
+          }
+
+          try {
+            detail::Reader in(file.data(), file.size());
+            if (in.read<uint64_t>() != magic()
+                || in.read_string() != t_filename
+                || in.read<int64_t>() != detail::modification_time(t_filename)
+                || in.read<uint64_t>() != t_input.size()
+                || in.read<uint64_t>() != detail::hash(t_input))
+            {
+              return AST_NodePtr();
+            }
+
+            AST_NodePtr ast = detail::Serializer(t_engine).read(in, std::make_shared<std::string>(t_filename));
+            return in.at_end() ? ast : AST_NodePtr();
+          } catch (const std::exception &) {
+            return AST_NodePtr();
+          }
+        }
+
+        /// Writes t_ast as the cache entry for t_filename. Trees the cache cannot reproduce and
+        /// failures to write the entry are ignored, the file is simply parsed again next time.
+        void store(chaiscript::detail::Dispatch_Engine &t_engine, const std::string &t_filename, const std::string &t_input,
+            const AST_NodePtr &t_ast) const
+        {
+          detail::Writer out;
+          out.write(magic());
+          out.write(t_filename);
+          out.write(detail::modification_time(t_filename));
+          out.write(static_cast<uint64_t>(t_input.size()));
+          out.write(detail::hash(t_input));
+
+          try {
+            detail::Serializer(t_engine).write(out, t_ast, std::make_shared<std::string>(t_filename));
+          } catch (const std::exception &) {
+            return;
+          }
+
+          const std::string path = entry_path(t_filename);
+          const std::string temp_path = path + ".tmp";
+
+          chaiscript::detail::threading::lock_guard<chaiscript::detail::threading::mutex> l(m_mutex);
+
+          {
+            std::ofstream outfile(temp_path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!outfile.is_open()) {
+              return;
+            }
+            outfile.write(out.data().data(), static_cast<std::streamsize>(out.data().size()));
+            if (!outfile) {
+              outfile.close();
+              std::remove(temp_path.c_str());
+              return;
+            }
+          }
+
+          // readers only ever see a complete entry
+          std::remove(path.c_str());
+          if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+          }
+        }
+
+      private:
+        /// Identifies the format version and the integer sizes and byte order of the writer
+        static uint64_t magic()
+        {
+          return 0x4348414941535400ULL // "CHAIAST"
+            | (uint64_t(1) << 2)       // format version
+            | uint64_t(sizeof(long) == 8 ? 1 : 0)
+            | (uint64_t(sizeof(long double) == 16 ? 1 : 0) << 1);
+        }
+
+        std::string entry_path(const std::string &t_filename) const
+        {
+          static const char digits[] = "0123456789abcdef";
+          std::string name;
+          for (uint64_t h = detail::hash(t_filename), i = 0; i < 16; ++i, h >>= 4)
+          {
+            name.insert(name.begin(), digits[h & 0xF]);
+          }
+          return m_directory + "/" + name + ".chaiast";
+        }
+
+        std::string m_directory;
+        mutable chaiscript::detail::threading::mutex m_mutex;
+    };
+  }
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include <cassert>
 #include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <exception>
 #include <fstream>
 #include <functional>
@@ -21,6 +22,11 @@
 #include <string>
 #include <vector>
 
+#ifndef CHAISCRIPT_NO_THREADS
+#include <condition_variable>
+#include <thread>
+#endif
+
 #include "../chaiscript_defines.hpp"
 #include "../chaiscript_threading.hpp"
 #include "../dispatchkit/boxed_cast_helper.hpp"
@@ -46,7 +52,13 @@
 
 
 #include "../dispatchkit/exception_specification.hpp"
+#include "chaiscript_ast_cache.hpp"
+#include "chaiscript_optimizer.hpp"
 #include "chaiscript_parser.hpp"
+// for add_cloning_algorithms, which the constructors add once the standard library has registered
+// the containers. It pulls in bootstrap.hpp, which names parser::ChaiScript_Parser without including
+// chaiscript_parser.hpp, so it has to come after it.
+#include "../dispatchkit/bootstrap_stl.hpp"
 #include "chaiscript_prelude.chai"
 
 namespace chaiscript
@@ -269,20 +281,205 @@ namespace chaiscript
 
     chaiscript::detail::Dispatch_Engine m_engine;
 
+    /// Whether parsed code goes through the optimizer before it is evaluated
+    bool m_optimize;
+
+    /// Parsed files kept on disk between runs, disabled unless a directory was given
+    cache::AST_Cache m_ast_cache;
+
+    /// Parses the given string, or takes its AST from the cache if t_filename was cached from
+    /// exactly this input. Returns a null pointer if nothing was parsed.
+    AST_NodePtr parse(const std::string &t_input, const std::string &t_filename)
+    {
+      const bool cacheable = m_ast_cache.enabled() && t_filename != "__EVAL__";
+      if (cacheable) {
+        AST_NodePtr ast = m_ast_cache.load(m_engine, t_filename, t_input);
+        if (ast) {
+          return ast;
+        }
+      }
+
+      parser::ChaiScript_Parser parser;
+      if (!parser.parse(t_input, t_filename)) {
+        return AST_NodePtr();
+      }
+
+      //parser.show_match_stack();
+      AST_NodePtr ast = parser.ast();
+      if (cacheable) {
+        // stored before the optimizer and compiler rewrite the tree
+        m_ast_cache.store(m_engine, t_filename, t_input, ast);
+      }
+      return ast;
+    }
+
     /// Evaluates the given string in by parsing it and running the results through the evaluator
     Boxed_Value do_eval(const std::string &t_input, const std::string &t_filename = "__EVAL__", bool /* t_internal*/  = false) 
     {
-      try {
-        parser::ChaiScript_Parser parser;
-        if (parser.parse(t_input, t_filename)) {
-          //parser.show_match_stack();
-          return parser.ast()->eval(m_engine);
-        } else {
-          return Boxed_Value();
-        }
+      return eval_parsed(parse(t_input, t_filename));
+    }
+
+    /// Loads, parses and evaluates the given file. The source text is released once it is
+    /// parsed, so it is not held in memory next to everything that evaluating it creates.
+    Boxed_Value do_eval_file(const std::string &t_filename)
+    {
+      AST_NodePtr ast;
+      {
+        const std::string input = load_file(t_filename);
+        ast = parse(input, t_filename);
       }
-      catch (chaiscript::eval::detail::Return_Value &rv) {
-        return rv.retval;
+      return eval_parsed(ast);
+    }
+
+    /// \brief Loads and parses the files given to eval_files(), handing the trees out in order
+    ///
+    /// Helper threads, one per extra core, each take the next file nobody has started on.
+    /// take() parses files itself while the one it needs is not ready yet, so without helpers
+    /// every file is simply parsed when it is due.
+    class File_Queue
+    {
+      public:
+        File_Queue(ChaiScript &t_chai, const std::vector<std::string> &t_filenames)
+          : m_chai(t_chai), m_filenames(t_filenames), m_files(t_filenames.size()), m_next(0)
+        {
+#ifndef CHAISCRIPT_NO_THREADS
+          const size_t num_threads = std::min<size_t>(m_files.size(), std::max(1u, std::thread::hardware_concurrency()));
+          try {
+            for (size_t i = 1; i < num_threads; ++i)
+            {
+              m_helpers.emplace_back([this]() { parse_remaining(); });
+            }
+          } catch (const std::system_error &) {
+            // parse with the threads we got
+          }
+#endif
+        }
+
+        ~File_Queue()
+        {
+          // files nobody has started on are not parsed anymore
+          m_next = m_files.size();
+#ifndef CHAISCRIPT_NO_THREADS
+          for (auto &helper : m_helpers)
+          {
+            helper.join();
+          }
+#endif
+        }
+
+        File_Queue(const File_Queue &) = delete;
+        File_Queue &operator=(const File_Queue &) = delete;
+
+        /// \returns The tree parsed from file t_index, rethrowing whatever loading or parsing it threw
+        AST_NodePtr take(size_t t_index)
+        {
+          while (!is_ready(t_index))
+          {
+            const size_t i = m_next++;
+            if (i < m_files.size()) {
+              parse(i);
+            } else {
+              wait_for(t_index);
+            }
+          }
+
+          Parsed_File &file = m_files[t_index];
+          if (file.error) {
+            std::rethrow_exception(file.error);
+          }
+
+          AST_NodePtr ast;
+          ast.swap(file.ast);
+          return ast;
+        }
+
+      private:
+        struct Parsed_File
+        {
+          Parsed_File() : ready(false) {}
+
+          AST_NodePtr ast;
+          std::exception_ptr error;
+          bool ready;
+        };
+
+        void parse(size_t t_index)
+        {
+          AST_NodePtr ast;
+          std::exception_ptr error;
+          try {
+            const std::string input = m_chai.load_file(m_filenames[t_index]);
+            ast = m_chai.parse(input, m_filenames[t_index]);
+          } catch (...) {
+            error = std::current_exception();
+          }
+
+          chaiscript::detail::threading::lock_guard<chaiscript::detail::threading::mutex> l(m_mutex);
+          m_files[t_index].ast = std::move(ast);
+          m_files[t_index].error = error;
+          m_files[t_index].ready = true;
+#ifndef CHAISCRIPT_NO_THREADS
+          m_ready.notify_all();
+#endif
+        }
+
+        void parse_remaining()
+        {
+          for (size_t i = m_next++; i < m_files.size(); i = m_next++)
+          {
+            parse(i);
+          }
+        }
+
+        bool is_ready(size_t t_index)
+        {
+          chaiscript::detail::threading::lock_guard<chaiscript::detail::threading::mutex> l(m_mutex);
+          return m_files[t_index].ready;
+        }
+
+        /// Blocks until a helper has finished file t_index
+        void wait_for(size_t t_index)
+        {
+#ifndef CHAISCRIPT_NO_THREADS
+          std::unique_lock<std::mutex> l(m_mutex);
+          m_ready.wait(l, [this, t_index]() { return m_files[t_index].ready; });
+#else
+          (void)t_index;
+#endif
+        }
+
+        ChaiScript &m_chai;
+        const std::vector<std::string> &m_filenames;
+        std::vector<Parsed_File> m_files;
+        std::atomic<size_t> m_next;
+        chaiscript::detail::threading::mutex m_mutex;
+#ifndef CHAISCRIPT_NO_THREADS
+        std::condition_variable m_ready;
+        std::vector<std::thread> m_helpers;
+#endif
+    };
+
+    /// Runs a tree returned by parse() through the optimizer and evaluator
+    Boxed_Value eval_parsed(const AST_NodePtr &t_ast)
+    {
+      AST_NodePtr ast = t_ast;
+      if (ast) {
+        if (m_optimize) {
+          ast = optimizer::Optimizer(m_engine).optimize(ast);
+        }
+
+        Boxed_Value retval = ast->eval(m_engine);
+
+        // a top level return ends the evaluation
+        auto &flow = m_engine.get_control_flow();
+        if (flow.type == chaiscript::detail::Control_Flow::Return) {
+          return flow.take_return_value();
+        }
+        chaiscript::eval::detail::check_no_loop_control(flow);
+
+        return retval;
+      } else {
+        return Boxed_Value();
       }
     }
 
@@ -325,10 +522,14 @@ namespace chaiscript
     /// \param[in] t_lib Standard library to apply to this ChaiScript instance
     /// \param[in] t_modulepaths Vector of paths to search when attempting to load a binary module
     /// \param[in] t_usepaths Vector of paths to search when attempting to "use" an included ChaiScript file
+    /// \param[in] t_ast_cache_directory Directory to keep the parsed AST of evaluated files in, so unchanged
+    ///            files, the prelude included, are not parsed again by later runs. Empty disables the cache.
     ChaiScript(const ModulePtr &t_lib,
                std::vector<std::string> t_modulepaths = std::vector<std::string>(),
-                      std::vector<std::string> t_usepaths = std::vector<std::string>())
-      : m_modulepaths(std::move(t_modulepaths)), m_usepaths(std::move(t_usepaths)) 
+                      std::vector<std::string> t_usepaths = std::vector<std::string>(),
+                      std::string t_ast_cache_directory = std::string())
+      : m_modulepaths(std::move(t_modulepaths)), m_usepaths(std::move(t_usepaths)), m_optimize(false),
+        m_ast_cache(std::move(t_ast_cache_directory))
     {
       if (m_modulepaths.empty())
       {
@@ -341,6 +542,7 @@ namespace chaiscript
       }
 
       build_eval_system(t_lib);
+      bootstrap::standard_library::add_cloning_algorithms(m_engine);
     }
 
     /// \brief Constructor for ChaiScript.
@@ -350,9 +552,13 @@ namespace chaiscript
     ///
     /// \param[in] t_modulepaths Vector of paths to search when attempting to load a binary module
     /// \param[in] t_usepaths Vector of paths to search when attempting to "use" an included ChaiScript file
+    /// \param[in] t_ast_cache_directory Directory to keep the parsed AST of evaluated files in, so unchanged
+    ///            files, the prelude included, are not parsed again by later runs. Empty disables the cache.
     ChaiScript( std::vector<std::string> t_modulepaths = std::vector<std::string>(),
-                      std::vector<std::string> t_usepaths = std::vector<std::string>())
-      : m_modulepaths(std::move(t_modulepaths)), m_usepaths(std::move(t_usepaths)) 
+                      std::vector<std::string> t_usepaths = std::vector<std::string>(),
+                      std::string t_ast_cache_directory = std::string())
+      : m_modulepaths(std::move(t_modulepaths)), m_usepaths(std::move(t_usepaths)), m_optimize(false),
+        m_ast_cache(std::move(t_ast_cache_directory))
     {
       if (m_modulepaths.empty())
       {
@@ -403,6 +609,7 @@ namespace chaiscript
       load_module("chaiscript_stdlib-" + version());
 
       build_eval_system(ModulePtr());
+      bootstrap::standard_library::add_cloning_algorithms(m_engine);
     }
 
     static int version_major()
@@ -533,6 +740,21 @@ namespace chaiscript
       m_engine.set_locals(t_locals);
     }
 
+    /// \brief Turns the AST optimizer on or off for code evaluated from now on
+    ///
+    /// The optimizer folds constant numeric expressions and removes redundant blocks, so the
+    /// evaluated tree no longer matches the source one for one. It is off by default.
+    void set_optimize(bool t_optimize)
+    {
+      m_optimize = t_optimize;
+    }
+
+    /// \returns True if parsed code is optimized before it is evaluated
+    bool get_optimize() const
+    {
+      return m_optimize;
+    }
+
     /// \brief Adds a type, function or object to ChaiScript. Objects are added to the local thread state.
     /// \param[in] t_t Item to add
     /// \param[in] t_name Name of item to add
@@ -686,7 +908,7 @@ namespace chaiscript
     /// \throw chaiscript::exception::eval_error In the case that evaluation fails.
     Boxed_Value eval_file(const std::string &t_filename, const Exception_Handler &t_handler = Exception_Handler()) {
       try {
-        return do_eval(load_file(t_filename), t_filename);
+        return do_eval_file(t_filename);
       } catch (Boxed_Value &bv) {
         if (t_handler) {
           t_handler->handle(bv, m_engine);
@@ -695,6 +917,38 @@ namespace chaiscript
       }
     }
 
+    /// \brief Loads and evaluates each of the given files, in the order given
+    ///
+    /// The files are read and parsed in parallel, with an independent parser for each and up
+    /// to one thread per core, while the calling thread evaluates them one at a time in order.
+    /// The outcome is the same as calling eval_file() on each in turn: a file sees everything
+    /// the files before it defined, and an error stops the files after it from being run.
+    ///
+    /// \param[in] t_filenames Files to load, parse and evaluate
+    /// \param[in] t_handler Optional Exception_Handler used for automatic unboxing of script thrown exceptions
+    /// \return The result of evaluating each file
+    /// \throw chaiscript::exception::eval_error In the case that parsing or evaluating a file fails.
+    /// \throw chaiscript::exception::file_not_found_error In the case that a file cannot be read.
+    std::vector<Boxed_Value> eval_files(const std::vector<std::string> &t_filenames, const Exception_Handler &t_handler = Exception_Handler()) {
+      File_Queue files(*this, t_filenames);
+      std::vector<Boxed_Value> results;
+      results.reserve(t_filenames.size());
+
+      try {
+        for (size_t i = 0; i < t_filenames.size(); ++i)
+        {
+          results.push_back(eval_parsed(files.take(i)));
+        }
+      } catch (Boxed_Value &bv) {
+        if (t_handler) {
+          t_handler->handle(bv, m_engine);
+        }
+        throw;
+      }
+
+      return results;
+    }
+
     /// \brief Loads the file specified by filename, evaluates it, and returns the type safe result.
     /// \tparam T Type to extract from the result value of the script execution
     /// \param[in] t_filename File to load and parse.
@@ -706,7 +960,7 @@ namespace chaiscript
     template<typename T>
     T eval_file(const std::string &t_filename, const Exception_Handler &t_handler = Exception_Handler()) {
       try {
-        return m_engine.boxed_cast<T>(do_eval(load_file(t_filename), t_filename));
+        return m_engine.boxed_cast<T>(do_eval_file(t_filename));
       } catch (Boxed_Value &bv) {
         if (t_handler) {
           t_handler->handle(bv, m_engine);
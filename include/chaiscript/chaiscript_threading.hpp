@@ -7,7 +7,9 @@
 #ifndef CHAISCRIPT_THREADING_HPP_
 #define CHAISCRIPT_THREADING_HPP_
 
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 #ifndef CHAISCRIPT_NO_THREADS
 #include <thread>
@@ -65,52 +67,132 @@ namespace chaiscript
       using std::recursive_mutex;
 
 #ifdef CHAISCRIPT_HAS_THREAD_LOCAL
-      /// Typesafe thread specific storage. If threading is enabled, this class uses a mutex protected map. If
-      /// threading is not enabled, the class always returns the same data, regardless of which thread it is called from.
+      /// Typesafe thread specific storage. If threading is enabled, each Thread_Storage owns a slot
+      /// index into a thread_local vector, so an access is an indexed load rather than a hash lookup.
+      /// If threading is not enabled, the class always returns the same data, regardless of which thread it is called from.
       template<typename T>
         class Thread_Storage
         {
           public:
 
-            Thread_Storage(void *t_key)
-              : m_key(t_key)
+            Thread_Storage(void *)
             {
+              Slot_Registry &r = registry();
+              lock_guard<mutex> l(r.m_mutex);
+
+              if (r.m_free.empty())
+              {
+                m_index = r.m_num_slots++;
+              } else {
+                m_index = r.m_free.back();
+                r.m_free.pop_back();
+              }
+
+              // a slot index is reused once its storage is destroyed, the generation
+              // tells this storage apart from the data other threads still hold for the old owner
+              m_generation = ++r.m_generation;
             }
 
+            Thread_Storage(const Thread_Storage &) = delete;
+            Thread_Storage &operator=(const Thread_Storage &) = delete;
+
             ~Thread_Storage()
             {
-              t().erase(m_key);
+              auto &slots = t();
+              if (m_index < slots.size() && slots[m_index].generation == m_generation)
+              {
+                slots[m_index].generation = 0;
+                slots[m_index].value.reset();
+              }
+
+              Slot_Registry &r = registry();
+              lock_guard<mutex> l(r.m_mutex);
+              r.m_free.push_back(m_index);
             }
 
             inline const T *operator->() const
             {
-              return &(t()[m_key]);
+              return get();
             }
 
             inline const T &operator*() const
             {
-              return t()[m_key];
+              return *get();
             }
 
             inline T *operator->()
             {
-              return &(t()[m_key]);
+              return get();
             }
 
             inline T &operator*()
             {
-              return t()[m_key];
+              return *get();
             }
 
+          private:
+            struct Slot
+            {
+              Slot() : generation(0) {}
 
-            void *m_key;
+              size_t generation;
+              std::unique_ptr<T> value;
+            };
 
-          private:
-            static std::unordered_map<void*, T> &t()
+            struct Slot_Registry
             {
-              thread_local static std::unordered_map<void *, T> my_t;
+              Slot_Registry() : m_num_slots(0), m_generation(0) {}
+
+              mutex m_mutex;
+              std::vector<size_t> m_free;
+              size_t m_num_slots;
+              size_t m_generation;
+            };
+
+            T *get() const
+            {
+              auto &slots = t();
+              if (m_index < slots.size())
+              {
+                Slot &slot = slots[m_index];
+                if (slot.generation == m_generation)
+                {
+                  return slot.value.get();
+                }
+              }
+
+              return create(slots);
+            }
+
+            /// First access from this thread, the value is held by unique_ptr so
+            /// that it stays put when the slot vector grows
+            T *create(std::vector<Slot> &t_slots) const
+            {
+              if (m_index >= t_slots.size())
+              {
+                t_slots.resize(m_index + 1);
+              }
+
+              Slot &slot = t_slots[m_index];
+              slot.value.reset(new T());
+              slot.generation = m_generation;
+              return slot.value.get();
+            }
+
+            static Slot_Registry &registry()
+            {
+              static Slot_Registry r;
+              return r;
+            }
+
+            static std::vector<Slot> &t()
+            {
+              thread_local static std::vector<Slot> my_t;
               return my_t;
             }
+
+            size_t m_index;
+            size_t m_generation;
         };
 
 #else
@@ -199,6 +281,8 @@ namespace chaiscript
 
       class shared_mutex { };
 
+      class mutex {};
+
       class recursive_mutex {};
 
 
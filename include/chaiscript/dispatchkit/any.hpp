@@ -7,6 +7,9 @@
 #ifndef CHAISCRIPT_ANY_HPP_
 #define CHAISCRIPT_ANY_HPP_
 
+#include <new>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
 
 namespace chaiscript {
@@ -46,8 +49,7 @@ namespace chaiscript {
       private:
         struct Data
         {
-          Data(const std::type_info &t_type) 
-            : m_type(t_type)
+          Data()
           {
           }
 
@@ -56,21 +58,49 @@ namespace chaiscript {
           virtual ~Data() {}
 
           virtual void *data() = 0;
-          const std::type_info &type() const
+
+          /// Virtual rather than stored, so a Data_Impl holding a std::shared_ptr is no bigger
+          /// than the pointer to its vtable and the shared_ptr itself
+          virtual const std::type_info &type() const = 0;
+
+          /// Copies the held object into t_buffer if it fits there, otherwise onto the heap
+          virtual Data *clone(void *t_buffer) const = 0;
+
+          /// Moves the held object into t_buffer, only called for objects that fit there
+          virtual Data *move(void *t_buffer) = 0;
+        };
+
+        /// Exactly the room for a Data_Impl holding a std::shared_ptr or std::reference_wrapper,
+        /// which is what Boxed_Value keeps in an Any
+        typedef std::aligned_storage<3 * sizeof(void *), std::alignment_of<void *>::value>::type Buffer;
+
+        template<typename T>
+          struct Fits_Buffer : std::integral_constant<bool, 
+            sizeof(T) <= sizeof(Buffer) 
+            && std::alignment_of<T>::value <= std::alignment_of<Buffer>::value
+            && std::is_nothrow_move_constructible<T>::value>
           {
-            return m_type;
+          };
+
+        /// Constructs a T in t_buffer, chosen when Fits_Buffer<T> holds
+        template<typename T, typename ... Args>
+          static T *construct(void *t_buffer, std::true_type, Args && ... t_args)
+          {
+            return new (t_buffer) T(std::forward<Args>(t_args)...);
           }
 
-          virtual std::unique_ptr<Data> clone() const = 0;
-          const std::type_info &m_type;
-        };
+        /// Constructs a T on the heap, chosen when Fits_Buffer<T> does not hold
+        template<typename T, typename ... Args>
+          static T *construct(void *, std::false_type, Args && ... t_args)
+          {
+            return new T(std::forward<Args>(t_args)...);
+          }
 
         template<typename T>
           struct Data_Impl : Data
           {
             explicit Data_Impl(T t_type)
-              : Data(typeid(T)),
-                m_data(std::move(t_type))
+              : m_data(std::move(t_type))
             {
             }
 
@@ -81,9 +111,19 @@ namespace chaiscript {
               return &m_data;
             }
 
-            std::unique_ptr<Data> clone() const CHAISCRIPT_OVERRIDE
+            virtual const std::type_info &type() const CHAISCRIPT_OVERRIDE
             {
-              return std::unique_ptr<Data>(new Data_Impl<T>(m_data));
+              return typeid(T);
+            }
+
+            virtual Data *clone(void *t_buffer) const CHAISCRIPT_OVERRIDE
+            {
+              return construct<Data_Impl<T> >(t_buffer, Fits_Buffer<Data_Impl<T> >(), m_data);
+            }
+
+            virtual Data *move(void *t_buffer) CHAISCRIPT_OVERRIDE
+            {
+              return construct<Data_Impl<T> >(t_buffer, Fits_Buffer<Data_Impl<T> >(), std::move(m_data));
             }
 
             Data_Impl &operator=(const Data_Impl&) = delete;
@@ -91,31 +131,78 @@ namespace chaiscript {
             T m_data;
           };
 
-        std::unique_ptr<Data> m_data;
+        template<typename T, typename ValueType>
+          Data *create(ValueType &&t_value)
+          {
+            return construct<Data_Impl<T> >(&m_buffer, Fits_Buffer<Data_Impl<T> >(), std::forward<ValueType>(t_value));
+          }
+
+        bool is_local() const
+        {
+          return static_cast<const void *>(m_data) == static_cast<const void *>(&m_buffer);
+        }
+
+        void reset()
+        {
+          if (m_data)
+          {
+            if (is_local())
+            {
+              m_data->~Data();
+            } else {
+              delete m_data;
+            }
+            m_data = nullptr;
+          }
+        }
+
+        void move_from(Any &t_other)
+        {
+          if (t_other.m_data && t_other.is_local())
+          {
+            m_data = t_other.m_data->move(&m_buffer);
+            t_other.reset();
+          } else {
+            m_data = t_other.m_data;
+            t_other.m_data = nullptr;
+          }
+        }
+
+        Data *m_data;
+        Buffer m_buffer;
 
       public:
         // construct/copy/destruct
-        Any() = default;
+        Any()
+          : m_data(nullptr)
+        {
+        }
 
         Any(const Any &t_any) 
+          : m_data(t_any.m_data ? t_any.m_data->clone(&m_buffer) : nullptr)
         { 
-          if (!t_any.empty())
+        }
+
+        Any(Any &&t_any)
+          : m_data(nullptr)
+        {
+          move_from(t_any);
+        }
+
+        Any &operator=(Any &&t_any)
+        {
+          if (this != &t_any)
           {
-            m_data = t_any.m_data->clone(); 
-          } else {
-            m_data.reset();
+            reset();
+            move_from(t_any);
           }
+          return *this;
         }
 
-#if !defined(_MSC_VER) || _MSC_VER  != 1800
-        Any(Any &&) = default;
-        Any &operator=(Any &&t_any) = default;
-#endif
-
         template<typename ValueType,
           typename = typename std::enable_if<!std::is_same<Any, typename std::decay<ValueType>::type>::value>::type>
         explicit Any(ValueType &&t_value)
-          : m_data(std::unique_ptr<Data>(new Data_Impl<typename std::decay<ValueType>::type>(std::forward<ValueType>(t_value))))
+          : m_data(create<typename std::decay<ValueType>::type>(std::forward<ValueType>(t_value)))
         {
         }
 
@@ -141,19 +228,22 @@ namespace chaiscript {
 
         ~Any()
         {
+          reset();
         }
 
         // modifiers
         Any & swap(Any &t_other)
         {
-          std::swap(t_other.m_data, m_data);
+          Any tmp(std::move(t_other));
+          t_other = std::move(*this);
+          *this = std::move(tmp);
           return *this;
         }
 
         // queries
         bool empty() const
         {
-          return !bool(m_data);
+          return m_data == nullptr;
         }
 
         const std::type_info & type() const
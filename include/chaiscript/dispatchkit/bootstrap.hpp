@@ -50,6 +50,32 @@ namespace chaiscript
       {
         return std::make_shared<P1>(v.get_as<P1>());
       }
+
+      /// \brief Copies a value with its copy constructor and keeps its attributes, as the prelude's clone() does
+      /// \param[in] t_params The value to copy
+      /// \returns The new copy
+      template<typename T>
+      Boxed_Value clone(const std::vector<Boxed_Value> &t_params)
+      {
+        Boxed_Value copy(T(boxed_cast<const T &>(t_params[0])));
+        return copy.copy_attrs(t_params[0]);
+      }
+    }
+
+    /// \brief Adds a native "clone" for the given copyable type to the given Module
+    ///
+    /// The prelude's clone() works for any type, but finds its constructor by evaluating the
+    /// name of the type on every call.
+    /// \param[in] type The name of the type
+    /// \param[in,out] m The Module to add the clone function to
+    /// \tparam T The type to add a clone function for
+    /// \returns The passed in ModulePtr, or the newly constructed one if the default param is used
+    template<typename T>
+    ModulePtr clone(const std::string &type, ModulePtr m = ModulePtr(new Module()))
+    {
+      m->add(Proxy_Function(new dispatch::Dynamic_Proxy_Function(&detail::clone<T>, 1, AST_NodePtr(),
+              dispatch::Param_Types({std::make_pair(type, user_type<T>())}))), "clone");
+      return m;
     }
 
     /// \brief Adds a copy constructor for the given type to the given Model
@@ -57,10 +83,12 @@ namespace chaiscript
     /// \param[in,out] m The Module to add the copy constructor to
     /// \tparam T The type to add a copy constructor for
     /// \returns The passed in ModulePtr, or the newly constructed one if the default param is used
+    /// \sa clone
     template<typename T>
     ModulePtr copy_constructor(const std::string &type, ModulePtr m = ModulePtr(new Module()))
     {
       m->add(constructor<T (const T &)>(), type);
+      clone<T>(type, m);
       return m;
     }
 
@@ -138,6 +166,7 @@ namespace chaiscript
       m->add(user_type<T>(), name);
       m->add(constructor<T ()>(), name);
       construct_pod<T>(name, m);
+      clone<T>(name, m);
 
       m->add(fun(&to_string<T>), "to_string");
       m->add(fun(&parse_string<T>), "to_" + name);
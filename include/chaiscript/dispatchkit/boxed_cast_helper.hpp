@@ -76,9 +76,9 @@ namespace chaiscript
           } else {
             if (!ob.get_type_info().is_const())
             {
-              return (ob.get().cast<std::shared_ptr<Result> >()).get();
+              return ob.get_value_ptr<Result>();
             } else {
-              return (ob.get().cast<std::shared_ptr<const Result> >()).get();
+              return ob.get_value_ptr<const Result>();
             }
           }
         }
@@ -95,7 +95,7 @@ namespace chaiscript
           {
             return &(ob.get().cast<std::reference_wrapper<Result> >()).get();
           } else {
-            return (ob.get().cast<std::shared_ptr<Result> >()).get();
+            return ob.get_value_ptr<Result>();
           }
         }
       };
@@ -126,7 +126,7 @@ namespace chaiscript
 
         static Result_Type cast(const Boxed_Value &ob, const Type_Conversions *)
         {
-          return ob.get().cast<std::shared_ptr<Result> >();
+          return ob.get_shared_ptr<Result>();
         }
       };
 
@@ -140,9 +140,9 @@ namespace chaiscript
         {
           if (!ob.get_type_info().is_const())
           {
-            return std::const_pointer_cast<const Result>(ob.get().cast<std::shared_ptr<Result> >());
+            return std::const_pointer_cast<const Result>(ob.get_shared_ptr<Result>());
           } else {
-            return ob.get().cast<std::shared_ptr<const Result> >();
+            return ob.get_shared_ptr<const Result>();
           }
         }
       };
@@ -58,7 +58,9 @@ namespace chaiscript
   /// \brief Represents any numeric type, generically. Used internally for generic operations between POD values
   class Boxed_Number
   {
-    private:
+    public:
+      /// Throws arithmetic_error for an integral division by zero, unless
+      /// CHAISCRIPT_NO_PROTECT_DIVIDEBYZERO is defined
       template<typename T>
       static void check_divide_by_zero(T t, typename std::enable_if<std::is_integral<T>::value>::type* = 0)
       {
@@ -74,6 +76,8 @@ namespace chaiscript
       {
       }
 
+    private:
+
       struct boolean
       {
 
@@ -895,6 +899,25 @@ namespace chaiscript
       struct Cast_Helper<const Boxed_Number> : Cast_Helper<Boxed_Number>
       {
       };
+
+    template<>
+      struct Cast_Check<Boxed_Number>
+      {
+        static bool can_cast(const Boxed_Value &bv, const Type_Conversions *)
+        {
+          return bv.get_type_info().is_arithmetic();
+        }
+      };
+
+    template<>
+      struct Cast_Check<const Boxed_Number &> : Cast_Check<Boxed_Number>
+      {
+      };
+
+    template<>
+      struct Cast_Check<const Boxed_Number> : Cast_Check<Boxed_Number>
+      {
+      };
   }
 
 #ifdef __GNUC__
@@ -8,7 +8,9 @@
 #define CHAISCRIPT_DISPATCHKIT_HPP_
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <deque>
 #include <iostream>
 #include <iterator>
@@ -31,6 +33,7 @@
 #include "dynamic_object.hpp"
 #include "proxy_constructors.hpp"
 #include "proxy_functions.hpp"
+#include "symbol.hpp"
 #include "type_info.hpp"
 
 namespace chaiscript {
@@ -235,8 +238,13 @@ namespace chaiscript
     {
       public:
         Dispatch_Function(std::vector<Proxy_Function> t_funcs)
-          : Proxy_Function_Base(build_type_infos(t_funcs), calculate_arity(t_funcs)),
-            m_funcs(std::move(t_funcs))
+          : Dispatch_Function(std::make_shared<const dispatch::Dispatch_Table>(std::move(t_funcs)))
+        {
+        }
+
+        Dispatch_Function(std::shared_ptr<const dispatch::Dispatch_Table> t_table)
+          : Proxy_Function_Base(build_type_infos(t_table->functions()), calculate_arity(t_table->functions())),
+            m_table(std::move(t_table))
         {
         }
 
@@ -244,7 +252,7 @@ namespace chaiscript
         {
           try {
             const auto &dispatchfun = dynamic_cast<const Dispatch_Function &>(rhs);
-            return m_funcs == dispatchfun.m_funcs;
+            return m_table->functions() == dispatchfun.m_table->functions();
           } catch (const std::bad_cast &) {
             return false;
           }
@@ -254,14 +262,21 @@ namespace chaiscript
 
         virtual std::vector<Const_Proxy_Function> get_contained_functions() const CHAISCRIPT_OVERRIDE
         {
-          return std::vector<Const_Proxy_Function>(m_funcs.begin(), m_funcs.end());
+          return std::vector<Const_Proxy_Function>(m_table->functions().begin(), m_table->functions().end());
+        }
+
+        /// \returns the precomputed dispatch table for the contained functions
+        const std::shared_ptr<const dispatch::Dispatch_Table> &get_dispatch_table() const
+        {
+          return m_table;
         }
 
         static int calculate_arity(const std::vector<Proxy_Function> &t_funcs);
 
         virtual bool call_match(const std::vector<Boxed_Value> &vals, const Type_Conversions &t_conversions) const CHAISCRIPT_OVERRIDE
         {
-          return std::any_of(m_funcs.cbegin(), m_funcs.cend(),
+          const auto &funcs = m_table->functions(vals.size());
+          return std::any_of(funcs.cbegin(), funcs.cend(),
                              [&vals, &t_conversions](const Proxy_Function &f){ return f->call_match(vals, t_conversions); });
         }
 
@@ -273,11 +288,11 @@ namespace chaiscript
       protected:
         virtual Boxed_Value do_call(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions) const CHAISCRIPT_OVERRIDE
         {
-          return dispatch::dispatch(m_funcs, params, t_conversions);
+          return m_table->dispatch(params, t_conversions);
         }
 
       private:
-        std::vector<Proxy_Function> m_funcs;
+        std::shared_ptr<const dispatch::Dispatch_Table> m_table;
 
         static std::vector<Type_Info> build_type_infos(const std::vector<Proxy_Function> &t_funcs);
     };
@@ -286,31 +301,297 @@ namespace chaiscript
 
   namespace detail
   {
+    /// Records a return, break or continue that is in progress on the current thread.
+    /// The statement sets it and returns normally; enclosing blocks stop evaluating while
+    /// it is pending, until the loop or function call that handles it resets it.
+    struct Control_Flow
+    {
+      enum Type { None, Return, Break, Continue };
+
+      Control_Flow()
+        : type(None)
+      {
+      }
+
+      bool pending() const
+      {
+        return type != None;
+      }
+
+      /// Resets the pending state and returns the value given to the return statement
+      Boxed_Value take_return_value()
+      {
+        type = None;
+        Boxed_Value rv;
+        std::swap(rv, retval);
+        return rv;
+      }
+
+      Type type;
+      Boxed_Value retval;
+    };
+
+    /// Stack of containers that keeps the storage of popped elements for reuse. A popped
+    /// element is cleared, releasing everything it holds, but keeps its capacity, so pushing
+    /// it again is an index bump and allocates nothing once the stack has been this deep before.
+    /// References to elements stay valid while they are on the stack.
+    template<typename T>
+      class Reusable_Stack
+      {
+        public:
+          typedef typename std::deque<T>::iterator iterator;
+          typedef typename std::deque<T>::const_iterator const_iterator;
+          typedef std::reverse_iterator<iterator> reverse_iterator;
+          typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+          Reusable_Stack()
+            : m_size(0)
+          {
+          }
+
+          /// \returns the new, empty, top element
+          T &push()
+          {
+            if (m_size == m_elems.size())
+            {
+              m_elems.emplace_back();
+            }
+            return m_elems[m_size++];
+          }
+
+          void pop()
+          {
+            assert(m_size > 0);
+            m_elems[--m_size].clear();
+          }
+
+          /// Pops every element
+          void clear()
+          {
+            while (m_size > 0)
+            {
+              pop();
+            }
+          }
+
+          size_t size() const { return m_size; }
+          bool empty() const { return m_size == 0; }
+
+          T &operator[](size_t t_idx) { return m_elems[t_idx]; }
+          const T &operator[](size_t t_idx) const { return m_elems[t_idx]; }
+
+          T &front() { return m_elems.front(); }
+          const T &front() const { return m_elems.front(); }
+          T &back() { return m_elems[m_size - 1]; }
+          const T &back() const { return m_elems[m_size - 1]; }
+
+          iterator begin() { return m_elems.begin(); }
+          const_iterator begin() const { return m_elems.begin(); }
+          iterator end() { return m_elems.begin() + static_cast<std::ptrdiff_t>(m_size); }
+          const_iterator end() const { return m_elems.begin() + static_cast<std::ptrdiff_t>(m_size); }
+
+          reverse_iterator rbegin() { return reverse_iterator(end()); }
+          const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+          reverse_iterator rend() { return reverse_iterator(begin()); }
+          const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        private:
+          std::deque<T> m_elems;
+          size_t m_size;
+      };
+
+    /// The objects of one scope, in the order they were added. A scope holding only a few
+    /// objects is searched linearly; a larger one also keeps an index from symbol to slot.
+    class Scope
+    {
+      public:
+        typedef std::pair<Symbol, Boxed_Value> value_type;
+        typedef std::vector<value_type>::iterator iterator;
+        typedef std::vector<value_type>::const_iterator const_iterator;
+
+        static const size_t npos = static_cast<size_t>(-1);
+
+        /// \returns the slot holding t_symbol, or npos
+        size_t find(const Symbol &t_symbol) const
+        {
+          if (m_objects.size() > linear_limit)
+          {
+            const size_t *slot = m_index.find(t_symbol);
+            if (slot) {
+              return *slot;
+            }
+            return npos;
+          }
+
+          for (size_t i = 0; i < m_objects.size(); ++i)
+          {
+            if (m_objects[i].first == t_symbol)
+            {
+              return i;
+            }
+          }
+
+          return npos;
+        }
+
+        /// Adds t_obj in a new slot, the caller makes sure t_symbol is not in the scope yet
+        void add(const Symbol &t_symbol, const Boxed_Value &t_obj)
+        {
+          m_objects.emplace_back(t_symbol, t_obj);
+
+          if (m_objects.size() == linear_limit + 1)
+          {
+            for (size_t i = 0; i < m_objects.size(); ++i)
+            {
+              m_index.set(m_objects[i].first, i);
+            }
+          } else if (m_objects.size() > linear_limit) {
+            m_index.set(t_symbol, m_objects.size() - 1);
+          }
+        }
+
+        void clear()
+        {
+          m_objects.clear();
+          m_index.clear();
+        }
+
+        size_t size() const { return m_objects.size(); }
+
+        value_type &operator[](size_t t_slot) { return m_objects[t_slot]; }
+        const value_type &operator[](size_t t_slot) const { return m_objects[t_slot]; }
+
+        iterator begin() { return m_objects.begin(); }
+        const_iterator begin() const { return m_objects.begin(); }
+        iterator end() { return m_objects.end(); }
+        const_iterator end() const { return m_objects.end(); }
+
+      private:
+        /// a linear search of this many symbols beats hashing
+        static const size_t linear_limit = 8;
+
+        std::vector<value_type> m_objects;
+        Symbol_Index<size_t> m_index;
+    };
+
+    /// Remembers where on the stack an identifier was last found, so that the next lookup
+    /// made from the same place can index straight into the scope holding the object, or skip
+    /// the stack if the identifier was not on it. The location is only trusted for the key it
+    /// was recorded under, see Dispatch_Engine::get_object
+    class Object_Location
+    {
+      public:
+        /// The scope index found for an identifier that is not on the stack
+        static const size_t not_on_stack = 0xFF;
+
+        Object_Location()
+          : m_loc(0)
+        {
+        }
+
+        /// \returns a key describing the shape of a thread's stack, or 0 if it is too large to record
+        static uint64_t key(uint32_t t_generation, size_t t_num_stacks, size_t t_stack_height)
+        {
+          if (t_num_stacks > 0xFF || t_stack_height > 0xFF)
+          {
+            return 0;
+          }
+
+          return (static_cast<uint64_t>(t_generation) << 32) | (t_num_stacks << 24) | (t_stack_height << 16);
+        }
+
+        /// \returns true and sets the scope index and slot if a location was recorded under t_key
+        bool find(uint64_t t_key, size_t &t_scope, size_t &t_slot) const
+        {
+          const uint64_t loc = m_loc.load(std::memory_order_relaxed);
+
+          if (t_key == 0 || (loc & ~uint64_t(0xFFFF)) != t_key)
+          {
+            return false;
+          }
+
+          t_scope = static_cast<size_t>((loc >> 8) & 0xFF);
+          t_slot = static_cast<size_t>(loc & 0xFF);
+          return true;
+        }
+
+        void set(uint64_t t_key, size_t t_scope, size_t t_slot)
+        {
+          if (t_key != 0 && t_scope < not_on_stack && t_slot <= 0xFF)
+          {
+            m_loc.store(t_key | (t_scope << 8) | t_slot, std::memory_order_relaxed);
+          }
+        }
+
+        /// Records that the identifier is not on the stack described by t_key
+        void set_not_on_stack(uint64_t t_key)
+        {
+          if (t_key != 0)
+          {
+            m_loc.store(t_key | (not_on_stack << 8), std::memory_order_relaxed);
+          }
+        }
+
+      private:
+        std::atomic<uint64_t> m_loc;
+    };
+
     /// Main class for the dispatchkit. Handles management
     /// of the object stack, functions and registered types.
     class Dispatch_Engine
     {
       public:
         typedef std::map<std::string, chaiscript::Type_Info> Type_Name_Map;
-        typedef std::map<std::string, Boxed_Value> Scope;
-        typedef std::vector<Scope> StackData;
+        typedef chaiscript::detail::Scope Scope;
+        typedef Reusable_Stack<Scope> StackData;
 
+        /// The registered functions, globals, types and reserved words. Each table is shared,
+        /// read only, by every copy of the State, so copying a State copies a few pointers. The
+        /// Dispatch_Engine copies a table before changing it if any other State still uses it.
         struct State
         {
-          std::map<std::string, std::vector<Proxy_Function> > m_functions;
-          std::map<std::string, Proxy_Function> m_function_objects;
-          std::map<std::string, Boxed_Value> m_global_objects;
-          Type_Name_Map m_types;
-          std::set<std::string> m_reserved_words;
+          typedef std::map<std::string, std::vector<Proxy_Function> > Functions;
+          typedef std::map<std::string, Proxy_Function> Function_Objects;
+          typedef std::map<std::string, std::shared_ptr<const dispatch::Dispatch_Table> > Dispatch_Tables;
+          typedef std::map<std::string, Boxed_Value> Global_Objects;
+          typedef std::set<std::string> Reserved_Words;
+
+          std::shared_ptr<const Functions> m_functions;
+          std::shared_ptr<const Function_Objects> m_function_objects;
+          std::shared_ptr<const Dispatch_Tables> m_dispatch_tables;
+          std::shared_ptr<const Global_Objects> m_global_objects;
+          std::shared_ptr<const Type_Name_Map> m_types;
+          std::shared_ptr<const Reserved_Words> m_reserved_words;
+
+          /// The dispatch tables, function objects and globals above indexed by symbol, for
+          /// lookups by the evaluator. Kept in step with the maps by the Dispatch_Engine.
+          std::shared_ptr<const Symbol_Index<std::shared_ptr<const dispatch::Dispatch_Table> > > m_symbol_dispatch_tables;
+          std::shared_ptr<const Symbol_Index<Proxy_Function> > m_symbol_function_objects;
+          std::shared_ptr<const Symbol_Index<Boxed_Value> > m_symbol_globals;
 
           State &operator=(const State &) = default;
-          State() = default;
           State(const State &) = default;
+
+          State()
+            : m_functions(std::make_shared<Functions>()),
+              m_function_objects(std::make_shared<Function_Objects>()),
+              m_dispatch_tables(std::make_shared<Dispatch_Tables>()),
+              m_global_objects(std::make_shared<Global_Objects>()),
+              m_types(std::make_shared<Type_Name_Map>()),
+              m_reserved_words(std::make_shared<Reserved_Words>()),
+              m_symbol_dispatch_tables(std::make_shared<Symbol_Index<std::shared_ptr<const dispatch::Dispatch_Table> > >()),
+              m_symbol_function_objects(std::make_shared<Symbol_Index<Proxy_Function> >()),
+              m_symbol_globals(std::make_shared<Symbol_Index<Boxed_Value> >())
+          {
+          }
         };
 
         Dispatch_Engine()
           : m_stack_holder(this),
-            m_place_holder(std::make_shared<dispatch::Placeholder_Object>())
+            m_function_generation(0),
+            m_state_version(0),
+            m_place_holder(std::make_shared<dispatch::Placeholder_Object>()),
+            m_place_holder_symbol("_")
         {
         }
 
@@ -333,33 +614,119 @@ namespace chaiscript
 
         /// Set the value of an object, by name. If the object
         /// is not available in the current scope it is created
-        void add(const Boxed_Value &obj, const std::string &name);
+        void add(const Boxed_Value &obj, const std::string &name)
+        {
+          add(obj, Symbol(name));
+        }
+
+        void add(const Boxed_Value &obj, const Symbol &t_symbol)
+        {
+          validate_object_name(t_symbol.name());
+
+          auto &stack = get_stack_data();
+
+          for (auto stack_elem = stack.rbegin(); stack_elem != stack.rend(); ++stack_elem)
+          {
+            const size_t slot = stack_elem->find(t_symbol);
+            if (slot != Scope::npos)
+            {
+              (*stack_elem)[slot].second = obj;
+              return;
+            }
+          }
+
+          add_object(t_symbol, obj);
+        }
 
 
         /// Adds a named object to the current scope
         /// \warning This version does not check the validity of the name
         /// it is meant for internal use only
-        void add_object(const std::string &name, const Boxed_Value &obj);
+        void add_object(const std::string &name, const Boxed_Value &obj)
+        {
+          add_object(Symbol(name), obj);
+        }
+
+        void add_object(const Symbol &t_symbol, const Boxed_Value &obj)
+        {
+          validate_object_name(t_symbol.name());
+
+          Stack_Holder &s = *m_stack_holder;
+          auto &stack = s.stacks.back();
+          auto &scope = stack.back();
+
+          if (scope.find(t_symbol) != Scope::npos)
+          {
+            throw chaiscript::exception::name_conflict_error(t_symbol.name());
+          }
+
+          // hiding an object of an enclosing scope, or a name that lookups have recorded as not
+          // on the stack, invalidates the locations recorded for the name
+          if (s.not_on_stack.find(t_symbol))
+          {
+            s.scope_generation = new_scope_generation();
+          } else {
+            for (auto stack_elem = stack.rbegin() + 1; stack_elem != stack.rend(); ++stack_elem)
+            {
+              if (stack_elem->find(t_symbol) != Scope::npos)
+              {
+                s.scope_generation = new_scope_generation();
+                break;
+              }
+            }
+          }
+
+          scope.add(t_symbol, obj);
+        }
 
         /// Adds a new global shared object, between all the threads
-        void add_global_const(const Boxed_Value &obj, const std::string &name);
+        void add_global_const(const Boxed_Value &obj, const std::string &name)
+        {
+          if (!obj.is_const())
+          {
+            throw chaiscript::exception::global_non_const();
+          }
+
+          add_global(obj, name);
+        }
 
 
         /// Adds a new global (non-const) shared object, between all the threads
-        void add_global(const Boxed_Value &obj, const std::string &name);
+        void add_global(const Boxed_Value &obj, const std::string &name)
+        {
+          validate_object_name(name);
+
+          chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_global_object_mutex);
+
+          if (m_state.m_global_objects->find(name) != m_state.m_global_objects->end())
+          {
+            throw chaiscript::exception::name_conflict_error(name);
+          } else {
+            writable(m_state.m_global_objects).insert(std::make_pair(name, obj));
+            writable(m_state.m_symbol_globals).set(Symbol(name), obj);
+            ++m_state_version;
+          }
+        }
 
 
         /// Adds a new scope to the stack
-        void new_scope();
+        void new_scope()
+        {
+          Stack_Holder &s = *m_stack_holder;
+          s.stacks.back().push();
+          s.call_params_scopes.push_back(s.call_params.size());
+        }
 
         /// Pops the current scope from the stack
         void pop_scope()
         {
-          m_stack_holder->call_params.pop_back();
-          StackData &stack = get_stack_data();
+          Stack_Holder &s = *m_stack_holder;
+          s.truncate_call_params(s.call_params_scopes.back());
+          s.call_params_scopes.pop_back();
+          StackData &stack = s.stacks.back();
           if (stack.size() > 1)
           {
-            stack.pop_back();
+            stack.pop();
           } else {
             throw std::range_error("Unable to pop global stack");
           }
@@ -370,46 +737,193 @@ namespace chaiscript
         void new_stack()
         {
           // add a new Stack with 1 element
-          m_stack_holder->stacks.emplace_back(1);
+          m_stack_holder->stacks.push().push();
         }
 
         void pop_stack()
         {
-          m_stack_holder->stacks.pop_back();
+          m_stack_holder->stacks.pop();
         }
 
         /// Searches the current stack for an object of the given name
         /// includes a special overload for the _ place holder object to
         /// ensure that it is always in scope.
-        Boxed_Value get_object(const std::string &name) const;
+        Boxed_Value get_object(const std::string &name) const
+        {
+          Object_Location loc;
+          return get_object(name, loc);
+        }
+
+        /// Searches the current stack for an object of the given name, starting
+        /// with the location t_loc at which the caller last found it.
+        /// t_loc is updated with the location of a local object that is found by searching.
+        Boxed_Value get_object(const std::string &name, Object_Location &t_loc) const
+        {
+          const Symbol symbol = Symbol::find(name);
+          if (!symbol.is_valid())
+          {
+            // nothing can have been registered under a name that was never interned
+            throw std::range_error("Object not found: " + name);
+          }
+
+          return get_object(symbol, t_loc);
+        }
+
+        /// Searches the current stack for an object named by t_symbol, see get_object(const std::string &, Object_Location &)
+        Boxed_Value get_object(const Symbol &t_symbol, Object_Location &t_loc) const
+        {
+          // Is it a placeholder object?
+          if (t_symbol == m_place_holder_symbol)
+          {
+            return m_place_holder;
+          }
+
+          const Stack_Holder &s = *m_stack_holder;
+          const auto &stack = s.stacks.back();
+
+          // The key changes with the shape of the stack and whenever a name is hidden by
+          // an inner scope, so a recorded location that still holds the name is the nearest one
+          const uint64_t key = Object_Location::key(s.scope_generation, s.stacks.size(), stack.size());
+
+          size_t scope_idx = 0;
+          size_t slot = 0;
+          const bool located = t_loc.find(key, scope_idx, slot);
+          if (located && scope_idx < stack.size())
+          {
+            const auto &scope = stack[scope_idx];
+            if (slot < scope.size() && scope[slot].first == t_symbol)
+            {
+              return scope[slot].second;
+            }
+          }
+
+          // Is it in the stack?
+          if (!located || scope_idx != Object_Location::not_on_stack)
+          {
+            for (scope_idx = stack.size(); scope_idx > 0; --scope_idx)
+            {
+              slot = stack[scope_idx - 1].find(t_symbol);
+              if (slot != Scope::npos)
+              {
+                t_loc.set(key, scope_idx - 1, slot);
+                return stack[scope_idx - 1][slot].second;
+              }
+            }
+
+            // adding the name to this thread's stack changes the scope generation from now on
+            if (key != 0)
+            {
+              if (!s.not_on_stack.find(t_symbol)) {
+                s.not_on_stack.set(t_symbol, true);
+              }
+              t_loc.set_not_on_stack(key);
+            }
+          }
+
+          const State &state = get_state_snapshot();
+
+          // Is the value we are looking for a global?
+          if (const Boxed_Value *global = state.m_symbol_globals->find(t_symbol))
+          {
+            return *global;
+          }
+
+          // If all that failed, then check to see if it's a function
+          if (const Proxy_Function *func = state.m_symbol_function_objects->find(t_symbol))
+          {
+            return const_var(*func);
+          }
+
+          throw std::range_error("Object not found: " + t_symbol.name());
+        }
 
         /// Registers a new named type
-        void add(const Type_Info &ti, const std::string &name);
+        void add(const Type_Info &ti, const std::string &name)
+        {
+          add_global_const(const_var(ti), name + "_type");
+
+          chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+
+          writable(m_state.m_types).insert(std::make_pair(name, ti));
+          ++m_state_version;
+        }
 
         /// Returns the type info for a named type
-        Type_Info get_type(const std::string &name) const;
+        Type_Info get_type(const std::string &name) const
+        {
+          const auto &types = *get_state_snapshot().m_types;
+          auto itr = types.find(name);
+
+          if (itr != types.end())
+          {
+            return itr->second;
+          }
+
+          throw std::range_error("Type Not Known");
+        }
 
         /// Returns the registered name of a known type_info object
         /// compares the "bare_type_info" for the broadest possible
         /// match
-        std::string get_type_name(const Type_Info &ti) const;
+        std::string get_type_name(const Type_Info &ti) const
+        {
+          for (const auto &elem : *get_state_snapshot().m_types)
+          {
+            if (elem.second.bare_equal(ti))
+            {
+              return elem.first;
+            }
+          }
+
+          return ti.bare_name();
+        }
 
         /// Return all registered types
         std::vector<std::pair<std::string, Type_Info> > get_types() const;
 
         /// Return a function by name
-        std::vector< Proxy_Function > get_function(const std::string &t_name) const;
+        std::vector< Proxy_Function > get_function(const std::string &t_name) const
+        {
+          const auto &funs = *get_state_snapshot().m_functions;
+
+          auto itr = funs.find(t_name);
+          if (itr != funs.end())
+          {
+            return itr->second;
+          } else {
+            return std::vector<Proxy_Function>();
+          }
+        }
 
         /// \returns a function object (Boxed_Value wrapper) if it exists
         /// \throws std::range_error if it does not
-        Boxed_Value get_function_object(const std::string &t_name) const;
+        Boxed_Value get_function_object(const std::string &t_name) const
+        {
+          const auto &funs = *get_state_snapshot().m_function_objects;
+
+          auto itr = funs.find(t_name);
+          if (itr != funs.end())
+          {
+            return const_var(itr->second);
+          } else {
+            throw std::range_error("Object not found: " + t_name);
+          }
+        }
+
+        Boxed_Value get_function_object(const Symbol &t_symbol) const
+        {
+          if (const Proxy_Function *func = get_state_snapshot().m_symbol_function_objects->find(t_symbol))
+          {
+            return const_var(*func);
+          } else {
+            throw std::range_error("Object not found: " + t_symbol.name());
+          }
+        }
 
         /// Return true if a function exists
         bool function_exists(const std::string &name) const
         {
-          chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
-
-          const auto &functions = get_functions_int();
+          const auto &functions = *get_state_snapshot().m_functions;
           return functions.find(name) != functions.end();
         }
 
@@ -418,12 +932,8 @@ namespace chaiscript
         std::map<std::string, Boxed_Value> get_parent_locals() const
         {
           auto &stack = get_stack_data();
-          if (stack.size() > 1)
-          {
-            return stack[1];
-          } else {
-            return stack[0];
-          }
+          const auto &scope = (stack.size() > 1) ? stack[1] : stack[0];
+          return to_map(scope);
         }
 
         /// \returns All values in the local thread state, added through the add() function
@@ -431,7 +941,7 @@ namespace chaiscript
         {
           auto &stack = get_stack_data();
           auto &scope = stack.front();
-          return scope;
+          return to_map(scope);
         }
 
         /// \brief Sets all of the locals for the current thread state.
@@ -441,15 +951,43 @@ namespace chaiscript
         /// Any existing locals are removed and the given set of variables is added
         void set_locals(const std::map<std::string, Boxed_Value> &t_locals)
         {
-          auto &stack = get_stack_data();
-          auto &scope = stack.front();
-          scope = t_locals;
+          Stack_Holder &s = *m_stack_holder;
+          auto &scope = s.stacks.back().front();
+          scope.clear();
+          for (const auto &local : t_locals)
+          {
+            scope.add(Symbol(local.first), local.second);
+          }
+          s.scope_generation = new_scope_generation();
         }
 
         ///
         /// Get a map of all objects that can be seen from the current scope in a scripting context
         ///
-        std::map<std::string, Boxed_Value> get_scripting_objects() const;
+        std::map<std::string, Boxed_Value> get_scripting_objects() const
+        {
+          const Stack_Holder &s = *m_stack_holder;
+
+          // We don't want the current context, but one up if it exists
+          const StackData &stack = (s.stacks.size()==1)?(s.stacks.back()):(s.stacks[s.stacks.size()-2]);
+
+          std::map<std::string, Boxed_Value> retval;
+
+          // note: map insert doesn't overwrite existing values, which is why this works
+          for (auto itr = stack.rbegin(); itr != stack.rend(); ++itr)
+          {
+            for (const auto &elem : *itr)
+            {
+              retval.insert(std::make_pair(elem.first.name(), elem.second));
+            }
+          }
+
+          // add the global values
+          const auto &globals = *get_state_snapshot().m_global_objects;
+          retval.insert(globals.begin(), globals.end());
+
+          return retval;
+        }
 
         ///
         /// Get a map of all functions that can be seen from a scripting context
@@ -459,16 +997,88 @@ namespace chaiscript
         /// Get a vector of all registered functions
         std::vector<std::pair<std::string, Proxy_Function > > get_functions() const;
 
-        void add_reserved_word(const std::string &name);
+        void add_reserved_word(const std::string &name)
+        {
+          chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+
+          writable(m_state.m_reserved_words).insert(name);
+          ++m_state_version;
+        }
 
         const Type_Conversions &conversions() const
         {
           return m_conversions;
         }
 
+        /// \returns the attribute layout shared by the objects of the script class t_class_name
+        std::shared_ptr<dispatch::Dynamic_Object_Shape> get_object_shape(const std::string &t_class_name)
+        {
+          return m_object_shapes.get(t_class_name);
+        }
+
+        /// \returns a number that changes whenever a function or a type conversion is registered.
+        ///          Used by call sites to validate any dispatch results they have cached.
+        size_t dispatch_generation() const
+        {
+          return m_function_generation + m_conversions.num_conversions();
+        }
+
+        /// \returns a number that changes whenever a function, type, global object or type conversion
+        ///          is registered. Used to validate results that depend on looking names up.
+        size_t lookup_generation() const
+        {
+          return m_state_version + m_conversions.num_conversions();
+        }
+
+        /// \returns the precomputed dispatch table for the named function, or an empty pointer if
+        ///          no function by that name exists
+        std::shared_ptr<const dispatch::Dispatch_Table> get_dispatch_table(const std::string &t_name) const
+        {
+          const auto &tables = *get_state_snapshot().m_dispatch_tables;
+          const auto itr = tables.find(t_name);
+          if (itr != tables.end())
+          {
+            return itr->second;
+          } else {
+            return std::shared_ptr<const dispatch::Dispatch_Table>();
+          }
+        }
+
+        std::shared_ptr<const dispatch::Dispatch_Table> get_dispatch_table(const Symbol &t_symbol) const
+        {
+          if (const auto *table = get_state_snapshot().m_symbol_dispatch_tables->find(t_symbol))
+          {
+            return *table;
+          } else {
+            return std::shared_ptr<const dispatch::Dispatch_Table>();
+          }
+        }
+
+        Boxed_Value call_function(const Symbol &t_symbol, const std::vector<Boxed_Value> &params) const
+        {
+          const auto table = get_dispatch_table(t_symbol);
+          if (table)
+          {
+            return table->dispatch(params, m_conversions);
+          } else {
+            throw chaiscript::exception::dispatch_error(params, std::vector<Const_Proxy_Function>());
+          }
+        }
+
+        Boxed_Value call_function(const Symbol &t_symbol, Boxed_Value p1, Boxed_Value p2) const
+        {
+          return call_function(t_symbol, std::vector<Boxed_Value>({std::move(p1), std::move(p2)}));
+        }
+
         Boxed_Value call_function(const std::string &t_name, const std::vector<Boxed_Value> &params) const
         {
-          return dispatch::dispatch(get_function(t_name), params, m_conversions);
+          const auto table = get_dispatch_table(t_name);
+          if (table)
+          {
+            return table->dispatch(params, m_conversions);
+          } else {
+            throw chaiscript::exception::dispatch_error(params, std::vector<Const_Proxy_Function>());
+          }
         }
 
         Boxed_Value call_function(const std::string &t_name) const
@@ -551,41 +1161,54 @@ namespace chaiscript
           chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l2(m_global_object_mutex);
 
           m_state = t_state;
+          index_symbols(m_state);
+          ++m_function_generation;
+          ++m_state_version;
         }
 
         void save_function_params(std::initializer_list<Boxed_Value> t_params)
         {
           Stack_Holder &s = *m_stack_holder;
-          s.call_params.back().insert(s.call_params.back().begin(), std::move(t_params));
+          s.call_params.insert(s.call_params.end(), t_params);
         }
 
         void save_function_params(std::vector<Boxed_Value> &&t_params)
         {
           Stack_Holder &s = *m_stack_holder;
 
-          for (auto &&param : t_params)
-          {
-            s.call_params.back().insert(s.call_params.back().begin(), std::move(param));
-          }
+          std::move(t_params.begin(), t_params.end(), std::back_inserter(s.call_params));
         }
 
         void save_function_params(const std::vector<Boxed_Value> &t_params)
         {
           Stack_Holder &s = *m_stack_holder;
-          s.call_params.back().insert(s.call_params.back().begin(), t_params.begin(), t_params.end());
+          s.call_params.insert(s.call_params.end(), t_params.begin(), t_params.end());
         }
 
         void new_function_call()
         {
           Stack_Holder &s = *m_stack_holder;
-          if (s.call_depth == 0)
+
+          // conversion results only need saving if there is a conversion to produce them
+          const bool has_conversions = m_conversions.num_conversions() != 0;
+
+          if (s.call_depth == 0 && has_conversions)
           {
             m_conversions.enable_conversion_saves(true);
           }
 
           ++s.call_depth;
 
-          save_function_params(m_conversions.take_saves());
+          if (has_conversions)
+          {
+            m_conversions.take_saves(s.call_params);
+          }
+        }
+
+        /// \returns the control flow state of the current thread
+        Control_Flow &get_control_flow()
+        {
+          return m_stack_holder->control_flow;
         }
 
         void pop_function_call()
@@ -597,12 +1220,67 @@ namespace chaiscript
 
           if (s.call_depth == 0)
           {
-            s.call_params.back().clear();
-            m_conversions.enable_conversion_saves(false);
+            s.truncate_call_params(s.call_params_scopes.back());
+
+            if (m_conversions.num_conversions() != 0)
+            {
+              m_conversions.enable_conversion_saves(false);
+            }
           }
         }
 
       private:
+        /// Returns a read only snapshot of the shared state. Writers update m_state under the
+        /// mutexes and bump m_state_version; each thread keeps the last snapshot it has seen
+        /// and only fetches a new one once the version has moved on. The latest snapshot is
+        /// published with atomic_store, so fetching it takes no lock unless it is out of date.
+        /// The returned reference is valid until the next call on the same thread.
+        const State &get_state_snapshot() const
+        {
+          const Stack_Holder &s = *m_stack_holder;
+          const size_t version = m_state_version;
+
+          if (!s.state || s.state_version != version)
+          {
+            auto published = std::atomic_load(&m_published_state);
+
+            if (!published || published->version != version)
+            {
+              chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+              chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l2(m_global_object_mutex);
+
+              published = std::make_shared<const Published_State>(m_state, m_state_version);
+              std::atomic_store(&m_published_state, published);
+            }
+
+            s.state = std::shared_ptr<const State>(published, &published->state);
+            s.state_version = published->version;
+          }
+
+          return *s.state;
+        }
+
+        /// \returns t_table ready to be changed, after copying it if another State shares it.
+        ///          The caller must hold the lock that guards the table.
+        ///
+        /// The published snapshot and this thread's own are dropped first, so the table is only
+        /// copied if another thread, or a State saved with get_state(), still uses it.
+        template<typename T>
+          T &writable(std::shared_ptr<const T> &t_table)
+          {
+            std::atomic_store(&m_published_state, std::shared_ptr<const Published_State>());
+            m_stack_holder->state.reset();
+
+            // only a copy made under the same lock can add a user, so a count of one stays one
+            if (t_table.use_count() != 1)
+            {
+              t_table = std::make_shared<T>(*t_table);
+            }
+
+            // every table is created non-const, see State()
+            return const_cast<T &>(*t_table);
+          }
+
         /// Returns the current stack
         /// make const/non const versions
         const StackData &get_stack_data() const
@@ -617,31 +1295,128 @@ namespace chaiscript
 
         const std::map<std::string, Proxy_Function> &get_function_objects_int() const
         {
-          return m_state.m_function_objects;
+          return *m_state.m_function_objects;
         }
 
         std::map<std::string, Proxy_Function> &get_function_objects_int() 
         {
-          return m_state.m_function_objects;
+          return writable(m_state.m_function_objects);
         }
 
         const std::map<std::string, std::vector<Proxy_Function> > &get_functions_int() const
         {
-          return m_state.m_functions;
+          return *m_state.m_functions;
         }
 
         std::map<std::string, std::vector<Proxy_Function> > &get_functions_int() 
         {
-          return m_state.m_functions;
+          return writable(m_state.m_functions);
         }
 
         static bool function_less_than(const Proxy_Function &lhs, const Proxy_Function &rhs);
 
+        static std::map<std::string, Boxed_Value> to_map(const Scope &t_scope)
+        {
+          std::map<std::string, Boxed_Value> retval;
+          for (const auto &elem : t_scope)
+          {
+            retval.insert(std::make_pair(elem.first.name(), elem.second));
+          }
+          return retval;
+        }
+
+        /// Rebuilds the symbol indexes of t_state from its maps
+        static void index_symbols(State &t_state)
+        {
+          auto tables = std::make_shared<Symbol_Index<std::shared_ptr<const dispatch::Dispatch_Table> > >();
+          for (const auto &table : *t_state.m_dispatch_tables)
+          {
+            tables->set(Symbol(table.first), table.second);
+          }
+          t_state.m_symbol_dispatch_tables = std::move(tables);
+
+          auto funcs = std::make_shared<Symbol_Index<Proxy_Function> >();
+          for (const auto &func : *t_state.m_function_objects)
+          {
+            funcs->set(Symbol(func.first), func.second);
+          }
+          t_state.m_symbol_function_objects = std::move(funcs);
+
+          auto globals = std::make_shared<Symbol_Index<Boxed_Value> >();
+          for (const auto &global : *t_state.m_global_objects)
+          {
+            globals->set(Symbol(global.first), global.second);
+          }
+          t_state.m_symbol_globals = std::move(globals);
+        }
+
+        /// \returns a scope generation that no thread has used yet, for Object_Location keys
+        static uint32_t new_scope_generation()
+        {
+          static std::atomic<uint32_t> generation(0);
+
+          uint32_t retval = ++generation;
+          while (retval == 0)
+          {
+            retval = ++generation;
+          }
+          return retval;
+        }
+
         /// Throw a reserved_word exception if the name is not allowed
         void validate_object_name(const std::string &name) const;
         /// Implementation detail for adding a function. 
         /// \throws exception::name_conflict_error if there's a function matching the given one being added
-        void add_function(const Proxy_Function &t_f, const std::string &t_name);
+        void add_function(const Proxy_Function &t_f, const std::string &t_name)
+        {
+          chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+
+          const Symbol symbol(t_name);
+          auto &funcs = get_functions_int();
+          auto itr = funcs.find(t_name);
+          auto &func_objs = get_function_objects_int();
+
+          if (itr != funcs.end())
+          {
+            auto &vec = itr->second;
+            for (const auto &func : vec)
+            {
+              if ((*t_f) == *func)
+              {
+                throw chaiscript::exception::name_conflict_error(t_name);
+              }
+            }
+
+            vec.push_back(t_f);
+            std::stable_sort(vec.begin(), vec.end(), &function_less_than);
+
+            const auto table = std::make_shared<const dispatch::Dispatch_Table>(vec);
+            writable(m_state.m_dispatch_tables)[t_name] = table;
+            func_objs[t_name] = std::make_shared<Dispatch_Function>(table);
+            writable(m_state.m_symbol_dispatch_tables).set(symbol, table);
+          } else {
+            std::vector<Proxy_Function> vec({t_f});
+            funcs.insert(std::make_pair(t_name, vec));
+
+            const auto table = std::make_shared<const dispatch::Dispatch_Table>(std::move(vec));
+            writable(m_state.m_dispatch_tables)[t_name] = table;
+
+            if (t_f->has_arithmetic_param()) {
+              // if the function is the only function but it also contains
+              // arithmetic operators, we must wrap it in a dispatch function
+              // to allow for automatic arithmetic type conversions
+              func_objs[t_name] = std::make_shared<Dispatch_Function>(table);
+            } else {
+              func_objs[t_name] = t_f;
+            }
+            writable(m_state.m_symbol_dispatch_tables).set(symbol, table);
+          }
+
+          writable(m_state.m_symbol_function_objects).set(symbol, func_objs[t_name]);
+
+          ++m_function_generation;
+          ++m_state_version;
+        }
 
         mutable chaiscript::detail::threading::shared_mutex m_mutex;
         mutable chaiscript::detail::threading::shared_mutex m_global_object_mutex;
@@ -649,16 +1424,41 @@ namespace chaiscript
         struct Stack_Holder
         {
           Stack_Holder()
-            : call_depth(0)
+            : call_depth(0), scope_generation(new_scope_generation()), state_version(0)
           {
-            stacks.emplace_back(1);
-            call_params.emplace_back();
+            stacks.push().push();
+            call_params_scopes.push_back(0);
           }
 
-          std::deque<StackData> stacks;
+          Reusable_Stack<StackData> stacks;
+
+          /// Function parameters and conversion results kept alive until the scope they were
+          /// saved in is popped or the outermost function call returns. call_params_scopes
+          /// holds the size of call_params at the start of each scope.
+          std::vector<Boxed_Value> call_params;
+          std::vector<size_t> call_params_scopes;
 
-          std::deque<std::list<Boxed_Value>> call_params;
+          /// Releases the saved call parameters above t_size, newest first
+          void truncate_call_params(size_t t_size)
+          {
+            while (call_params.size() > t_size)
+            {
+              call_params.pop_back();
+            }
+          }
           int call_depth;
+          Control_Flow control_flow;
+
+          /// changes whenever a local object hides another one of the same name, or takes a name
+          /// in not_on_stack, see get_object()
+          uint32_t scope_generation;
+
+          /// the names get_object() has recorded as not on this thread's stack
+          mutable Symbol_Index<bool> not_on_stack;
+
+          /// this thread's snapshot of the shared state, see get_state_snapshot()
+          mutable std::shared_ptr<const State> state;
+          mutable size_t state_version;
         };
 
         Type_Conversions m_conversions;
@@ -666,8 +1466,27 @@ namespace chaiscript
 
 
         State m_state;
+        std::atomic_size_t m_function_generation;
+        std::atomic_size_t m_state_version;
+        /// the State as of m_state_version == version, shared by the threads that read it
+        struct Published_State
+        {
+          Published_State(const State &t_state, size_t t_version)
+            : state(t_state), version(t_version)
+          {
+          }
+
+          State state;
+          size_t version;
+        };
+
+        /// only accessed through std::atomic_load and std::atomic_store
+        mutable std::shared_ptr<const Published_State> m_published_state;
 
         Boxed_Value m_place_holder;
+        Symbol m_place_holder_symbol;
+
+        dispatch::Dynamic_Object_Shapes m_object_shapes;
     };
   }
 }
@@ -7,6 +7,7 @@
 #ifndef CHAISCRIPT_DYNAMIC_OBJECT_HPP_
 #define CHAISCRIPT_DYNAMIC_OBJECT_HPP_
 
+#include <atomic>
 #include <cassert>
 #include <map>
 #include <memory>
@@ -16,6 +17,7 @@
 #include <vector>
 
 #include "../chaiscript_defines.hpp"
+#include "../chaiscript_threading.hpp"
 #include "boxed_cast.hpp"
 #include "boxed_cast_helper.hpp"
 #include "boxed_value.hpp"
@@ -32,32 +34,207 @@ namespace chaiscript
 {
   namespace dispatch
   {
+    /// The layout shared by the objects of one script class: each attribute declared for the
+    /// class with `attr` is given a slot, and an object keeps those attributes in a vector indexed
+    /// by slot. Attributes set on an object without being declared are kept by the object itself,
+    /// so they never grow the layout. Slots are only ever added, so a slot found once stays valid.
+    class Dynamic_Object_Shape
+    {
+      public:
+        static const size_t npos = static_cast<size_t>(-1);
+
+        Dynamic_Object_Shape()
+          : m_layout(std::make_shared<const Layout>())
+        {
+        }
+
+        /// \returns the slot of the named attribute, or npos if it was not declared. Takes no lock,
+        ///          the layout read is one that no writer changes.
+        size_t find(const std::string &t_attr_name) const
+        {
+          const auto layout = std::atomic_load(&m_layout);
+
+          const auto itr = layout->slots.find(t_attr_name);
+          if (itr != layout->slots.end()) {
+            return itr->second;
+          }
+          return npos;
+        }
+
+        /// \returns the slot of the named attribute, giving it a new one if it has none yet
+        size_t declare(const std::string &t_attr_name)
+        {
+          chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::mutex> l(m_mutex);
+
+          const auto itr = m_layout->slots.find(t_attr_name);
+          if (itr != m_layout->slots.end())
+          {
+            return itr->second;
+          }
+
+          auto layout = std::make_shared<Layout>(*m_layout);
+          layout->names.push_back(t_attr_name);
+          const size_t slot = layout->names.size() - 1;
+          layout->slots.insert(std::make_pair(t_attr_name, slot));
+          std::atomic_store(&m_layout, std::shared_ptr<const Layout>(std::move(layout)));
+          return slot;
+        }
+
+        std::string name(size_t t_slot) const
+        {
+          return std::atomic_load(&m_layout)->names[t_slot];
+        }
+
+      private:
+        struct Layout
+        {
+          std::map<std::string, size_t> slots;
+          std::vector<std::string> names;
+        };
+
+        /// replaced, never modified, when an attribute is declared
+        std::shared_ptr<const Layout> m_layout;
+        chaiscript::detail::threading::mutex m_mutex;
+    };
+
+    /// The shapes of the script classes known to one engine, by class name
+    class Dynamic_Object_Shapes
+    {
+      public:
+        /// \returns the shape of the objects of class t_class_name
+        std::shared_ptr<Dynamic_Object_Shape> get(const std::string &t_class_name)
+        {
+          chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::mutex> l(m_mutex);
+
+          auto &shape = m_shapes[t_class_name];
+          if (!shape) {
+            shape = std::make_shared<Dynamic_Object_Shape>();
+          }
+          return shape;
+        }
+
+      private:
+        std::map<std::string, std::shared_ptr<Dynamic_Object_Shape>> m_shapes;
+        chaiscript::detail::threading::mutex m_mutex;
+    };
+
     class Dynamic_Object
     {
       public:
+        /// An object of no script class, all of its attributes are kept by name
         Dynamic_Object(std::string t_type_name)
           : m_type_name(std::move(t_type_name))
         {
         }
 
+        Dynamic_Object(std::string t_type_name, std::shared_ptr<Dynamic_Object_Shape> t_shape)
+          : m_type_name(std::move(t_type_name)), m_shape(std::move(t_shape))
+        {
+        }
+
         std::string get_type_name() const
         {
           return m_type_name;
         }
 
+        /// \returns the shape of the object's class, or a null pointer if it was not made by a class constructor
+        const std::shared_ptr<Dynamic_Object_Shape> &get_shape() const
+        {
+          return m_shape;
+        }
+
         Boxed_Value get_attr(const std::string &t_attr_name)
         {
+          const size_t slot = m_shape ? m_shape->find(t_attr_name) : Dynamic_Object_Shape::npos;
+          if (slot != Dynamic_Object_Shape::npos)
+          {
+            return get_slot(slot);
+          }
+
           return m_attrs[t_attr_name];
         }
 
+        /// \returns the attribute in slot t_slot of t_shape, which must be this object's shape
+        ///          for the slot to be used. Otherwise the attribute is found by its name.
+        Boxed_Value get_attr_in_slot(const Dynamic_Object_Shape &t_shape, size_t t_slot, const std::string &t_attr_name)
+        {
+          if (&t_shape == m_shape.get())
+          {
+            return get_slot(t_slot);
+          } else {
+            return get_attr(t_attr_name);
+          }
+        }
+
+        /// \returns the attribute in slot t_slot of this object's shape, adding it if it is not set
+        Boxed_Value get_slot(size_t t_slot)
+        {
+          if (m_slots && t_slot < m_slots->size() && (*m_slots)[t_slot].is_set)
+          {
+            return (*m_slots)[t_slot].value;
+          }
+
+          if (!m_slots) {
+            m_slots = std::make_shared<std::vector<Slot>>();
+          } else if (m_slots.use_count() > 1) {
+            m_slots = std::make_shared<std::vector<Slot>>(*m_slots);
+          }
+
+          if (m_slots->size() <= t_slot) {
+            m_slots->resize(t_slot + 1);
+          }
+
+          Slot &slot = (*m_slots)[t_slot];
+          slot.is_set = true;
+
+          // the attribute may have been set by name before it was declared
+          if (!m_attrs.empty())
+          {
+            const auto itr = m_attrs.find(m_shape->name(t_slot));
+            if (itr != m_attrs.end())
+            {
+              slot.value = itr->second;
+              m_attrs.erase(itr);
+            }
+          }
+
+          return slot.value;
+        }
+
         std::map<std::string, Boxed_Value> get_attrs() const
         {
-          return m_attrs;
+          std::map<std::string, Boxed_Value> attrs(m_attrs);
+          if (m_slots)
+          {
+            for (size_t i = 0; i < m_slots->size(); ++i)
+            {
+              if ((*m_slots)[i].is_set) {
+                attrs.insert(std::make_pair(m_shape->name(i), (*m_slots)[i].value));
+              }
+            }
+          }
+          return attrs;
         }
 
       private:
+        struct Slot
+        {
+          Slot()
+            : is_set(false)
+          {
+          }
+
+          Boxed_Value value;
+          bool is_set;
+        };
+
         std::string m_type_name;
+        std::shared_ptr<Dynamic_Object_Shape> m_shape;
+
+        /// the declared attributes, shared with copies of this object until one of them sets a new one
+        std::shared_ptr<std::vector<Slot>> m_slots;
 
+        /// attributes that are not declared for the object's class
         std::map<std::string, Boxed_Value> m_attrs;
     };
 
@@ -121,6 +121,28 @@ namespace chaiscript
           }
         }
       };
+
+    /// Any function object may be cast to a std::function, the signature is checked when it is called
+    template<typename Signature>
+      struct Cast_Check<std::function<Signature> >
+      {
+        static bool can_cast(const Boxed_Value &bv, const Type_Conversions *t_conversions)
+        {
+          return bv.get_type_info().bare_equal(user_type<Const_Proxy_Function>())
+            || user_type<std::function<Signature> >().bare_equal(bv.get_type_info())
+            || (t_conversions && t_conversions->convertable_type<std::function<Signature> >());
+        }
+      };
+
+    template<typename Signature>
+      struct Cast_Check<const std::function<Signature> > : Cast_Check<std::function<Signature> >
+      {
+      };
+
+    template<typename Signature>
+      struct Cast_Check<const std::function<Signature> &> : Cast_Check<std::function<Signature> >
+      {
+      };
   }
 }
 
@@ -10,15 +10,19 @@
 
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <memory>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include "../chaiscript_defines.hpp"
+#include "../chaiscript_threading.hpp"
 #include "boxed_cast.hpp"
 #include "boxed_cast_helper.hpp"
 #include "boxed_value.hpp"
@@ -41,6 +45,23 @@ namespace chaiscript
 
   typedef std::shared_ptr<AST_Node> AST_NodePtr;
 
+  namespace exception
+  {
+    /// \brief  Exception thrown if a function's guard fails
+    class guard_error : public std::runtime_error
+    {
+      public:
+        guard_error() CHAISCRIPT_NOEXCEPT
+          : std::runtime_error("Guard evaluation failed")
+        { }
+
+        guard_error(const guard_error &) = default;
+
+        virtual ~guard_error() CHAISCRIPT_NOEXCEPT
+        { }
+    };
+  }
+
   namespace dispatch
   {
     class Param_Types
@@ -151,6 +172,17 @@ namespace chaiscript
           return bv;
         }
 
+        /// Calls the function if it accepts the parameters. Unlike operator(), a rejection of the
+        /// parameters is reported by returning false instead of throwing bad_boxed_cast, arity_error
+        /// or guard_error, so overload resolution can try candidates without unwinding the stack.
+        /// \param[out] t_result receives the return value if the function was called
+        /// \returns true if the function was called
+        bool try_call(const std::vector<Boxed_Value> &params, const chaiscript::Type_Conversions &t_conversions, 
+            Boxed_Value &t_result) const
+        {
+          return do_try_call(params, t_conversions, t_result);
+        }
+
         /// Returns a vector containing all of the types of the parameters the function returns/takes
         /// if the function is variadic or takes no arguments (arity of 0 or -1), the returned
         /// value contains exactly 1 Type_Info object: the return type
@@ -218,6 +250,25 @@ namespace chaiscript
       protected:
         virtual Boxed_Value do_call(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions) const = 0;
 
+        /// Default try_call implementation, for functions that have no cheaper way of rejecting
+        /// parameters than attempting the call. Overridden to check the parameters up front.
+        virtual bool do_try_call(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions, 
+            Boxed_Value &t_result) const
+        {
+          try {
+            t_result = do_call(params, t_conversions);
+            return true;
+          } catch (const exception::bad_boxed_cast &) {
+            //parameter failed to cast
+          } catch (const exception::arity_error &) {
+            //invalid num params
+          } catch (const exception::guard_error &) {
+            //guard failed to allow the function to execute
+          }
+
+          return false;
+        }
+
         Proxy_Function_Base(std::vector<Type_Info> t_types, int t_arity)
           : m_types(std::move(t_types)), m_arity(t_arity), m_has_arithmetic_param(false)
         {
@@ -277,23 +328,6 @@ namespace chaiscript
   ///        are handled internally.
   typedef std::shared_ptr<const dispatch::Proxy_Function_Base> Const_Proxy_Function;
 
-  namespace exception
-  {
-    /// \brief  Exception thrown if a function's guard fails
-    class guard_error : public std::runtime_error
-    {
-      public:
-        guard_error() CHAISCRIPT_NOEXCEPT
-          : std::runtime_error("Guard evaluation failed")
-        { }
-
-        guard_error(const guard_error &) = default;
-
-        virtual ~guard_error() CHAISCRIPT_NOEXCEPT
-        { }
-    };
-  }
-
   namespace dispatch
   {
     /**
@@ -369,6 +403,25 @@ namespace chaiscript
           } 
         }
 
+        virtual bool do_try_call(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions, 
+            Boxed_Value &t_result) const CHAISCRIPT_OVERRIDE
+        {
+          if (!call_match(params, t_conversions))
+          {
+            return false;
+          }
+
+          try {
+            t_result = m_f(params);
+            return true;
+          } catch (const exception::bad_boxed_cast &) {
+          } catch (const exception::arity_error &) {
+          } catch (const exception::guard_error &) {
+          }
+
+          return false;
+        }
+
       private:
         bool test_guard(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions) const
         {
@@ -412,6 +465,169 @@ namespace chaiscript
         std::function<Boxed_Value (const std::vector<Boxed_Value> &)> m_f;
     };
 
+    /**
+     * The guard of a Dynamic_Proxy_Function, evaluated by a native predicate instead of its parse tree.
+     *
+     * The predicate reports through its second parameter whether the outcome it returned depends only
+     * on the types of the parameters and on what is registered with the engine. Such outcomes are
+     * remembered per list of parameter types, tagged with the generation number returned by
+     * t_generation; any change in the registered functions, types, globals or conversions must change
+     * that number. Remembered outcomes are read from a published snapshot, without taking a lock.
+     */
+    class Type_Guard_Function : public Dynamic_Proxy_Function
+    {
+      public:
+        typedef std::function<bool (const std::vector<Boxed_Value> &, bool &)> Predicate;
+
+        Type_Guard_Function(Predicate t_predicate, std::function<size_t ()> t_generation, int t_arity,
+            AST_NodePtr t_parsenode)
+          : Dynamic_Proxy_Function([this](const std::vector<Boxed_Value> &t_params) { return Boxed_Value(test(t_params)); },
+              t_arity, std::move(t_parsenode)),
+            m_predicate(std::move(t_predicate)), m_generation(std::move(t_generation)), m_value_dependent(false),
+            m_memo(std::make_shared<const Memo>())
+        {
+        }
+
+        virtual ~Type_Guard_Function() {}
+
+        /// \returns true if no outcome of the guard has depended on more than the types of its
+        ///          parameters, other than those for Dynamic_Object parameters
+        bool is_type_decided() const
+        {
+          return !m_value_dependent;
+        }
+
+        /// \returns true if an outcome for the types of t_params is remembered, which means that the
+        ///          guard gives the same answer for any parameters of those types
+        bool is_memoized(const std::vector<Boxed_Value> &t_params) const
+        {
+          const size_t generation = m_generation();
+          const auto memo = std::atomic_load(&m_memo);
+
+          return std::any_of(memo->entries.begin(), memo->entries.end(),
+              [&](const Entry &t_entry) { return t_entry.generation == generation && t_entry.matches(t_params); });
+        }
+
+      private:
+        bool test(const std::vector<Boxed_Value> &t_params) const
+        {
+          const bool memoizable = !has_dynamic_object(t_params);
+          const size_t generation = m_generation();
+
+          if (memoizable)
+          {
+            const auto memo = std::atomic_load(&m_memo);
+
+            for (const auto &entry : memo->entries)
+            {
+              if (entry.generation == generation && entry.matches(t_params))
+              {
+                return entry.result;
+              }
+            }
+          }
+
+          bool types_only = true;
+          const bool result = m_predicate(t_params, types_only);
+
+          if (memoizable && !types_only)
+          {
+            m_value_dependent = true;
+          }
+
+          if (memoizable && types_only)
+          {
+            chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::mutex> l(m_mutex);
+
+            auto memo = std::make_shared<Memo>(*m_memo);
+
+            Entry &entry = memo->entries[memo->next];
+            memo->next = (memo->next + 1) % memo->entries.size();
+
+            entry.used = true;
+            entry.generation = generation;
+            entry.result = result;
+            entry.types.clear();
+            for (const auto &param : t_params)
+            {
+              entry.types.push_back(std::make_pair(param.get_type_info(), param.is_ref()));
+            }
+
+            std::atomic_store(&m_memo, std::shared_ptr<const Memo>(std::move(memo)));
+          }
+
+          return result;
+        }
+
+        /// The class of a Dynamic_Object is given by its type name, which the parameter types do not show
+        static bool has_dynamic_object(const std::vector<Boxed_Value> &t_params)
+        {
+          for (const auto &param : t_params)
+          {
+            if (param.get_type_info().bare_equal(user_type<Dynamic_Object>()))
+            {
+              return true;
+            }
+          }
+
+          return false;
+        }
+
+        struct Entry
+        {
+          Entry()
+            : used(false), generation(0), result(false)
+          {
+          }
+
+          bool matches(const std::vector<Boxed_Value> &t_params) const
+          {
+            if (!used || types.size() != t_params.size())
+            {
+              return false;
+            }
+
+            for (size_t i = 0; i < t_params.size(); ++i)
+            {
+              const Type_Info &ti = t_params[i].get_type_info();
+              if (!(types[i].first == ti && types[i].first.bare_equal(ti)
+                    && types[i].first.is_const() == ti.is_const()
+                    && types[i].first.is_undef() == ti.is_undef()
+                    && types[i].second == t_params[i].is_ref()))
+              {
+                return false;
+              }
+            }
+
+            return true;
+          }
+
+          bool used;
+          size_t generation;
+          bool result;
+          std::vector<std::pair<Type_Info, bool> > types;
+        };
+
+        struct Memo
+        {
+          Memo()
+            : next(0)
+          {
+          }
+
+          std::array<Entry, 8> entries;
+          size_t next;
+        };
+
+        Predicate m_predicate;
+        std::function<size_t ()> m_generation;
+        mutable std::atomic<bool> m_value_dependent;
+        /// serializes the writers, readers only load m_memo
+        mutable chaiscript::detail::threading::mutex m_mutex;
+        /// replaced, never modified, when an outcome is remembered; only accessed through std::atomic_load and std::atomic_store
+        mutable std::shared_ptr<const Memo> m_memo;
+    };
+
     /**
      * An object used by Bound_Function to represent "_" parameters
      * of a binding. This allows for unbound parameters during bind.
@@ -522,6 +738,12 @@ namespace chaiscript
           return (*m_f)(build_param_list(params), t_conversions);
         }
 
+        virtual bool do_try_call(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions, 
+            Boxed_Value &t_result) const CHAISCRIPT_OVERRIDE
+        {
+          return m_f->try_call(build_param_list(params), t_conversions, t_result);
+        }
+
       private:
         Const_Proxy_Function m_f;
         std::vector<Boxed_Value> m_args;
@@ -593,6 +815,17 @@ namespace chaiscript
           return detail::Do_Call<typename std::function<Func>::result_type>::go(m_f, params, t_conversions);
         }
 
+        virtual bool do_try_call(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions, 
+            Boxed_Value &t_result) const CHAISCRIPT_OVERRIDE
+        {
+          if (!detail::can_cast_params(m_dummy_func, params, t_conversions))
+          {
+            return false;
+          }
+
+          return Proxy_Function_Impl_Base::do_try_call(params, t_conversions, t_result);
+        }
+
       private:
         std::function<Func> m_f;
         Func *m_dummy_func;
@@ -659,6 +892,17 @@ namespace chaiscript
           }
         }
 
+        virtual bool do_try_call(const std::vector<Boxed_Value> &params, const Type_Conversions &t_conversions, 
+            Boxed_Value &t_result) const CHAISCRIPT_OVERRIDE
+        {
+          if (params.size() != 1 || !can_boxed_cast<const Class *>(params[0], &t_conversions))
+          {
+            return false;
+          }
+
+          return Proxy_Function_Base::do_try_call(params, t_conversions, t_result);
+        }
+
       private:
         static std::vector<Type_Info> param_types()
         {
@@ -725,9 +969,30 @@ namespace chaiscript
           return true;
         }
 
+      /// \returns the functions to list in a dispatch_error: t_reported if provided, otherwise [begin, end)
+      template<typename InItr>
+        std::vector<Const_Proxy_Function> reported_functions(InItr begin, const InItr &end, 
+            const std::vector<Proxy_Function> *t_reported)
+        {
+          if (t_reported)
+          {
+            return std::vector<Const_Proxy_Function>(t_reported->begin(), t_reported->end());
+          } else {
+            return std::vector<Const_Proxy_Function>(begin, end);
+          }
+        }
+
+      /// \returns true if t_func is one of t_skip, the candidates that were already tried with these parameters
+      template<typename Func>
+        bool is_skipped(const Func &t_func, const std::vector<Const_Proxy_Function> *t_skip)
+        {
+          return t_skip && std::find(t_skip->begin(), t_skip->end(), t_func) != t_skip->end();
+        }
+
       template<typename InItr>
         Boxed_Value dispatch_with_conversions(InItr begin, const InItr &end, const std::vector<Boxed_Value> &plist, 
-            const Type_Conversions &t_conversions)
+            const Type_Conversions &t_conversions, const std::vector<Proxy_Function> *t_reported = nullptr,
+            const std::vector<Const_Proxy_Function> *t_skip = nullptr)
         {
           InItr orig(begin);
 
@@ -742,17 +1007,17 @@ namespace chaiscript
                 matching_func = begin;
               } else {
                 // More than one function matches, not attempting
-                throw exception::dispatch_error(plist, std::vector<Const_Proxy_Function>(orig, end));
+                throw exception::dispatch_error(plist, reported_functions(orig, end, t_reported));
               }
             }
 
             ++begin;
           }
 
-          if (matching_func == end)
+          if (matching_func == end || is_skipped(*matching_func, t_skip))
           {
-            // no appropriate function to attempt arithmetic type conversion on
-            throw exception::dispatch_error(plist, std::vector<Const_Proxy_Function>(orig, end));
+            // no appropriate function to attempt arithmetic type conversion on, or it already refused these parameters
+            throw exception::dispatch_error(plist, reported_functions(orig, end, t_reported));
           }
 
 
@@ -769,17 +1034,13 @@ namespace chaiscript
             }
           }
 
-          try {
-            return (*(*matching_func))(newplist, t_conversions);
-          } catch (const exception::bad_boxed_cast &) {
-            //parameter failed to cast
-          } catch (const exception::arity_error &) {
-            //invalid num params
-          } catch (const exception::guard_error &) {
-            //guard failed to allow the function to execute
+          Boxed_Value retval;
+          if ((*matching_func)->try_call(newplist, t_conversions, retval))
+          {
+            return retval;
           }
 
-          throw exception::dispatch_error(plist, std::vector<Const_Proxy_Function>(orig, end));
+          throw exception::dispatch_error(plist, reported_functions(orig, end, t_reported));
 
         }
     }
@@ -788,13 +1049,20 @@ namespace chaiscript
      * Take a vector of functions and a vector of parameters. Attempt to execute
      * each function against the set of parameters, in order, until a matching
      * function is found or throw dispatch_error if no matching function is found
+     *
+     * If t_matched is provided it receives the function that was called, as long as
+     * it was selected without applying any arithmetic conversions to the parameters.
+     * If t_reported is provided it replaces funcs as the list of candidates given in a dispatch_error
+     * If t_skip is provided, the functions in it have already been tried with plist and are not called again
      */
     template<typename Funcs>
       Boxed_Value dispatch(const Funcs &funcs,
-          const std::vector<Boxed_Value> &plist, const Type_Conversions &t_conversions)
+          const std::vector<Boxed_Value> &plist, const Type_Conversions &t_conversions,
+          Const_Proxy_Function *t_matched = nullptr, const std::vector<Proxy_Function> *t_reported = nullptr,
+          const std::vector<Const_Proxy_Function> *t_skip = nullptr)
       {
 
-        std::multimap<size_t, const Proxy_Function_Base *> ordered_funcs;
+        std::multimap<size_t, const typename Funcs::value_type *> ordered_funcs;
 
         for (const auto &func : funcs)
         {
@@ -816,28 +1084,408 @@ namespace chaiscript
             continue;
           }
 
-          ordered_funcs.insert(std::make_pair(numdiffs, func.get()));
+          if (detail::is_skipped(func, t_skip))
+          {
+            continue;
+          }
+
+          ordered_funcs.insert(std::make_pair(numdiffs, &func));
         }
 
+        Boxed_Value retval;
         for (const auto &func : ordered_funcs )
         {
-          try {
-            if (func.second->filter(plist, t_conversions))
+          // a rejected candidate returns false, try again
+          if ((*func.second)->filter(plist, t_conversions) 
+              && (*func.second)->try_call(plist, t_conversions, retval))
+          {
+            if (t_matched)
             {
-              return (*(func.second))(plist, t_conversions);
+              *t_matched = *func.second;
             }
-          } catch (const exception::bad_boxed_cast &) {
-            //parameter failed to cast, try again
-          } catch (const exception::arity_error &) {
-            //invalid num params, try again
-          } catch (const exception::guard_error &) {
-            //guard failed to allow the function to execute,
-            //try again
+            return retval;
           }
         }
 
-        return detail::dispatch_with_conversions(funcs.cbegin(), funcs.cend(), plist, t_conversions);
+        return detail::dispatch_with_conversions(funcs.cbegin(), funcs.cend(), plist, t_conversions, t_reported, t_skip);
       }
+
+    /**
+     * The overloads registered under a single name, organized for dispatch when they are
+     * registered rather than on every call. Overloads are bucketed by arity and indexed
+     * by the exact (bare) types of their parameters, so that a call whose parameter types
+     * exactly match an overload is resolved with a hash lookup. All other calls fall back to
+     * the ranking done by dispatch(), restricted to the overloads of the right arity.
+     *
+     * Whether the choice between the overloads can be remembered by a Call_Site_Cache is
+     * also worked out here, from the guards of the overloads.
+     */
+    class Dispatch_Table
+    {
+      public:
+        /// \param[in] t_funcs the overloads, in the order dispatch should consider them
+        explicit Dispatch_Table(std::vector<Proxy_Function> t_funcs)
+          : m_funcs(std::move(t_funcs)),
+            m_decidable(collect_type_guards(m_funcs, m_type_guards))
+        {
+          for (const auto &func : m_funcs)
+          {
+            const int arity = func->get_arity();
+
+            if (arity < 0)
+            {
+              // variadic functions are candidates for calls of any size
+              m_variadic.push_back(func);
+              for (auto &bucket : m_by_arity)
+              {
+                bucket.push_back(func);
+              }
+              m_exact[signature_hash(std::vector<Type_Info>(1))].push_back(func);
+            } else {
+              if (m_by_arity.size() <= size_t(arity))
+              {
+                m_by_arity.resize(size_t(arity) + 1, m_variadic);
+              }
+              m_by_arity[size_t(arity)].push_back(func);
+              m_exact[signature_hash(func->get_param_types())].push_back(func);
+            }
+          }
+        }
+
+        /// \returns all of the overloads, in dispatch order
+        const std::vector<Proxy_Function> &functions() const
+        {
+          return m_funcs;
+        }
+
+        /// \returns the overloads that can accept t_arity parameters, in dispatch order
+        const std::vector<Proxy_Function> &functions(size_t t_arity) const
+        {
+          if (t_arity < m_by_arity.size())
+          {
+            return m_by_arity[t_arity];
+          } else {
+            return m_variadic;
+          }
+        }
+
+        /// Perform the same dispatch as dispatch::dispatch() over functions()
+        /// Each overload is called at most once: the ones tried by the exact lookup are skipped by the fallback.
+        /// \param[in] t_skip if given, overloads that were already tried with t_params and are not called again
+        Boxed_Value dispatch(const std::vector<Boxed_Value> &t_params, const Type_Conversions &t_conversions,
+            Const_Proxy_Function *t_matched = nullptr, const std::vector<Const_Proxy_Function> *t_skip = nullptr) const
+        {
+          const auto exact = m_exact.find(signature_hash(t_params));
+
+          if (exact == m_exact.end())
+          {
+            return dispatch::dispatch(functions(t_params.size()), t_params, t_conversions, t_matched, &m_funcs, t_skip);
+          }
+
+          // only filled in once an overload has refused the parameters
+          std::vector<Const_Proxy_Function> tried;
+
+          Boxed_Value retval;
+          for (const auto &func : exact->second)
+          {
+            // skipping hash collisions
+            if (!is_exact_match(*func, t_params) || detail::is_skipped(func, t_skip))
+            {
+              continue;
+            }
+
+            if (func->filter(t_params, t_conversions) 
+                && func->try_call(t_params, t_conversions, retval))
+            {
+              if (t_matched)
+              {
+                *t_matched = func;
+              }
+              return retval;
+            }
+
+            if (tried.empty() && t_skip)
+            {
+              tried = *t_skip;
+            }
+            tried.push_back(func);
+          }
+
+          return dispatch::dispatch(functions(t_params.size()), t_params, t_conversions, t_matched, &m_funcs, 
+              tried.empty() ? t_skip : &tried);
+        }
+
+        /// \returns true if the outcome of dispatching t_params depends only on the types of the
+        ///          parameters: no parameter is a Dynamic_Object and every guard of an overload is
+        ///          a Type_Guard_Function that has only ever been decided by types
+        bool is_cacheable(const std::vector<Boxed_Value> &t_params) const
+        {
+          return m_decidable && is_type_decided(m_type_guards, t_params);
+        }
+
+        /// \returns true if none of the overloads has a guard
+        bool is_unguarded() const
+        {
+          return m_decidable && m_type_guards.empty();
+        }
+
+        /// Same as is_cacheable() for functions that are not in a table, working the guards out on each call
+        template<typename Funcs>
+          static bool is_cacheable(const Funcs &t_funcs, const std::vector<Boxed_Value> &t_params)
+          {
+            std::vector<std::shared_ptr<const Type_Guard_Function> > guards;
+            return collect_type_guards(t_funcs, guards) && is_type_decided(guards, t_params);
+          }
+
+      private:
+        /// Adds the guards of t_funcs and of the functions they contain to t_guards
+        /// \returns false if one of the guards is not a Type_Guard_Function
+        template<typename Funcs>
+          static bool collect_type_guards(const Funcs &t_funcs, std::vector<std::shared_ptr<const Type_Guard_Function> > &t_guards)
+          {
+            for (const auto &func : t_funcs)
+            {
+              const auto dynamic = std::dynamic_pointer_cast<const Dynamic_Proxy_Function>(func);
+              if (dynamic && dynamic->get_guard())
+              {
+                auto type_guard = std::dynamic_pointer_cast<const Type_Guard_Function>(dynamic->get_guard());
+                if (!type_guard)
+                {
+                  return false;
+                }
+                t_guards.push_back(std::move(type_guard));
+              }
+
+              if (!collect_type_guards(func->get_contained_functions(), t_guards))
+              {
+                return false;
+              }
+            }
+
+            return true;
+          }
+
+        static bool is_type_decided(const std::vector<std::shared_ptr<const Type_Guard_Function> > &t_guards,
+            const std::vector<Boxed_Value> &t_params)
+        {
+          for (const auto &param : t_params)
+          {
+            if (param.get_type_info().bare_equal(user_type<Dynamic_Object>()))
+            {
+              return false;
+            }
+          }
+
+          for (const auto &guard : t_guards)
+          {
+            if (!guard->is_type_decided())
+            {
+              return false;
+            }
+          }
+
+          return true;
+        }
+
+        static size_t combine_hash(size_t t_seed, const Type_Info &t_ti)
+        {
+          const size_t h = t_ti.bare_type_info() ? t_ti.bare_type_info()->hash_code() : 0;
+          return t_seed ^ (h + 0x9e3779b9 + (t_seed << 6) + (t_seed >> 2));
+        }
+
+        /// hash of the parameter types of a function, skipping the return type
+        static size_t signature_hash(const std::vector<Type_Info> &t_types)
+        {
+          size_t seed = t_types.empty() ? 0 : t_types.size() - 1;
+          for (size_t i = 1; i < t_types.size(); ++i)
+          {
+            seed = combine_hash(seed, t_types[i]);
+          }
+          return seed;
+        }
+
+        static size_t signature_hash(const std::vector<Boxed_Value> &t_params)
+        {
+          size_t seed = t_params.size();
+          for (const auto &param : t_params)
+          {
+            seed = combine_hash(seed, param.get_type_info());
+          }
+          return seed;
+        }
+
+        /// true if dispatch() would rank t_func as having no differences from t_params
+        static bool is_exact_match(const Proxy_Function_Base &t_func, const std::vector<Boxed_Value> &t_params)
+        {
+          const int arity = t_func.get_arity();
+
+          if (arity < 0)
+          {
+            return t_params.empty();
+          } else if (size_t(arity) != t_params.size()) {
+            return false;
+          }
+
+          const std::vector<Type_Info> &types = t_func.get_param_types();
+          for (size_t i = 0; i < t_params.size(); ++i)
+          {
+            if (!types[i+1].bare_equal(t_params[i].get_type_info()))
+            {
+              return false;
+            }
+          }
+
+          return true;
+        }
+
+        std::vector<Proxy_Function> m_funcs;
+        std::vector<Proxy_Function> m_variadic;
+        std::vector<std::vector<Proxy_Function> > m_by_arity;
+        std::unordered_map<size_t, std::vector<Proxy_Function> > m_exact;
+        std::vector<std::shared_ptr<const Type_Guard_Function> > m_type_guards;
+        bool m_decidable;
+    };
+
+    /**
+     * Small polymorphic inline cache kept by a call site. It remembers which function
+     * dispatch() selected for a given call site key and list of parameter types, so that
+     * later calls with the same types can skip the overload ranking entirely.
+     *
+     * Entries are tagged with a generation number provided by the caller, any change
+     * in the set of registered functions or conversions must change that number.
+     *
+     * The entries are never modified once published: a lookup takes no lock and reads
+     * a snapshot, while a change copies the entries and publishes the copy.
+     */
+    class Call_Site_Cache
+    {
+      public:
+        Call_Site_Cache()
+          : m_entries(std::make_shared<const Entries>())
+        {
+        }
+
+        Call_Site_Cache(const Call_Site_Cache &) = delete;
+        Call_Site_Cache &operator=(const Call_Site_Cache &) = delete;
+
+        /// \returns the function cached for the site and parameter types, or an empty pointer
+        Const_Proxy_Function find(const void *t_site, size_t t_generation, const std::vector<Boxed_Value> &t_params) const
+        {
+          const auto entries = std::atomic_load(&m_entries);
+
+          for (const auto &entry : entries->entries)
+          {
+            if (entry.func && entry.site.get() == t_site && entry.generation == t_generation 
+                && entry.matches(t_params))
+            {
+              return entry.func;
+            }
+          }
+
+          return Const_Proxy_Function();
+        }
+
+        /// Remember t_func as the result of dispatching t_params at t_site, replacing the oldest entry.
+        /// t_site is held on to so that its address cannot be reused while it is cached.
+        void insert(std::shared_ptr<const void> t_site, size_t t_generation, const std::vector<Boxed_Value> &t_params,
+            Const_Proxy_Function t_func)
+        {
+          chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::mutex> l(m_mutex);
+
+          auto entries = std::make_shared<Entries>(*m_entries);
+
+          Entry &entry = entries->entries[entries->next];
+          entries->next = (entries->next + 1) % entries->entries.size();
+
+          entry.site = std::move(t_site);
+          entry.generation = t_generation;
+          entry.func = std::move(t_func);
+          entry.types.clear();
+          for (const auto &param : t_params)
+          {
+            entry.types.push_back(std::make_pair(param.get_type_info(), param.is_ref()));
+          }
+
+          std::atomic_store(&m_entries, std::shared_ptr<const Entries>(std::move(entries)));
+        }
+
+        /// Forget t_func at t_site, leaving the entries of other functions and sites in place
+        void erase(const void *t_site, const Const_Proxy_Function &t_func)
+        {
+          chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::mutex> l(m_mutex);
+
+          auto entries = std::make_shared<Entries>(*m_entries);
+
+          for (auto &entry : entries->entries)
+          {
+            if (entry.site.get() == t_site && entry.func == t_func)
+            {
+              entry = Entry();
+            }
+          }
+
+          std::atomic_store(&m_entries, std::shared_ptr<const Entries>(std::move(entries)));
+        }
+
+        void clear()
+        {
+          chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::mutex> l(m_mutex);
+
+          std::atomic_store(&m_entries, std::make_shared<const Entries>());
+        }
+
+      private:
+        struct Entry
+        {
+          Entry()
+            : generation(0)
+          {
+          }
+
+          bool matches(const std::vector<Boxed_Value> &t_params) const
+          {
+            if (types.size() != t_params.size())
+            {
+              return false;
+            }
+
+            for (size_t i = 0; i < t_params.size(); ++i)
+            {
+              const Type_Info &ti = t_params[i].get_type_info();
+              if (!(types[i].first == ti && types[i].first.bare_equal(ti) 
+                    && types[i].first.is_const() == ti.is_const()
+                    && types[i].first.is_undef() == ti.is_undef()
+                    && types[i].second == t_params[i].is_ref()))
+              {
+                return false;
+              }
+            }
+
+            return true;
+          }
+
+          std::shared_ptr<const void> site;
+          size_t generation;
+          std::vector<std::pair<Type_Info, bool> > types;
+          Const_Proxy_Function func;
+        };
+
+        struct Entries
+        {
+          Entries()
+            : next(0)
+          {
+          }
+
+          std::array<Entry, 4> entries;
+          size_t next;
+        };
+
+        /// serializes the writers, readers only load m_entries
+        chaiscript::detail::threading::mutex m_mutex;
+        /// replaced, never modified, by a writer; only accessed through std::atomic_load and std::atomic_store
+        std::shared_ptr<const Entries> m_entries;
+    };
   }
 }
 
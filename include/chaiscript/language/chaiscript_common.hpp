@@ -467,26 +467,6 @@ namespace chaiscript
     namespace detail
     {
 
-      /// Special type for returned values
-      struct Return_Value {
-        Boxed_Value retval;
-
-        Return_Value(const Boxed_Value &t_return_value) : retval(t_return_value) { }
-      };
-
-
-      /// Special type indicating a call to 'break'
-      struct Break_Loop {
-        Break_Loop() { }
-      };
-
-
-      /// Special type indicating a call to 'continue'
-      struct Continue_Loop {
-        Continue_Loop() { }
-      };
-
-
       /// Creates a new scope then pops it on destruction
       struct Scope_Push_Pop
       {
@@ -8,6 +8,7 @@
 #define CHAISCRIPT_EVAL_HPP_
 
 #include <assert.h>
+#include <atomic>
 #include <cstdlib>
 #include <exception>
 #include <functional>
@@ -46,27 +47,478 @@ namespace chaiscript
   {
     namespace detail
     {
+      /// Throws if a break or continue is still pending once the function or script it was in
+      /// has finished, meaning there was no loop around it
+      static void check_no_loop_control(chaiscript::detail::Control_Flow &t_flow)
+      {
+        const auto type = t_flow.type;
+        if (type == chaiscript::detail::Control_Flow::Break || type == chaiscript::detail::Control_Flow::Continue) {
+          t_flow.type = chaiscript::detail::Control_Flow::None;
+          throw exception::eval_error(std::string(type == chaiscript::detail::Control_Flow::Break ? "'break'" : "'continue'")
+              + " used outside of a loop");
+        }
+      }
+
       /// Helper function that will set up the scope around a function call, including handling the named function parameters
-      static Boxed_Value eval_function(chaiscript::detail::Dispatch_Engine &t_ss, const AST_NodePtr &t_node, const std::vector<std::string> &t_param_names, const std::vector<Boxed_Value> &t_vals) {
+      static Boxed_Value eval_function(chaiscript::detail::Dispatch_Engine &t_ss, const AST_NodePtr &t_node, const std::vector<chaiscript::detail::Symbol> &t_param_names, const std::vector<Boxed_Value> &t_vals) {
         chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
 
         for (size_t i = 0; i < t_param_names.size(); ++i) {
           t_ss.add_object(t_param_names[i], t_vals[i]);
         }
 
-        try {
-          return t_node->eval(t_ss);
-        } catch (detail::Return_Value &rv) {
-          return rv.retval;
-        } 
+        Boxed_Value retval = t_node->eval(t_ss);
+
+        auto &flow = t_ss.get_control_flow();
+        if (flow.type == chaiscript::detail::Control_Flow::Return) {
+          return flow.take_return_value();
+        }
+
+        check_no_loop_control(flow);
+        return retval;
       }
+
+      /// Dispatches t_params through the call site's inline cache. On a miss t_get_table is
+      /// used to fetch the dispatch table of the candidates and the selected function is remembered.
+      /// If a cached function rejects the parameters its entry is dropped and a full dispatch is done
+      /// over the other candidates.
+      /// Entries are tagged with the lookup generation, as the guards of cached overloads may look names up.
+      /// \param[out] t_matched if given, receives the function that was called
+      template<typename Get_Table>
+        Boxed_Value cached_dispatch(const chaiscript::detail::Dispatch_Engine &t_ss, dispatch::Call_Site_Cache &t_cache,
+            const std::shared_ptr<const void> &t_site, const std::vector<Boxed_Value> &t_params, const Get_Table &t_get_table,
+            Const_Proxy_Function *t_matched = nullptr)
+        {
+          const size_t generation = t_ss.lookup_generation();
+
+          const Const_Proxy_Function cached = t_cache.find(t_site.get(), generation, t_params);
+          if (cached)
+          {
+            Boxed_Value retval;
+            if (cached->try_call(t_params, t_ss.conversions(), retval))
+            {
+              if (t_matched) {
+                *t_matched = cached;
+              }
+              return retval;
+            }
+
+            t_cache.erase(t_site.get(), cached);
+          }
+
+          const auto table = t_get_table();
+          if (!table)
+          {
+            throw exception::dispatch_error(t_params, std::vector<Const_Proxy_Function>());
+          }
+
+          // the cached function has already refused these parameters
+          const std::vector<Const_Proxy_Function> tried = cached ? std::vector<Const_Proxy_Function>{cached} 
+                                                                 : std::vector<Const_Proxy_Function>();
+
+          Const_Proxy_Function matched;
+          Boxed_Value retval = table->dispatch(t_params, t_ss.conversions(), &matched, cached ? &tried : nullptr);
+
+          if (t_matched) {
+            *t_matched = matched;
+          }
+
+          if (matched && table->is_cacheable(t_params))
+          {
+            t_cache.insert(t_site, generation, t_params, std::move(matched));
+          }
+
+          return retval;
+        }
+
+      /// Turns the guard of a script function into a native predicate when the guard is built only from
+      /// - conditions joined by `&&`, `||` and `!`
+      /// - `call_exists(f, ...)`, where f is a function name or `eval(type_name(x))`
+      /// - `function_exists(type_name(x))`
+      /// - `is_type(x, "name")` and `x.is_type("name")`
+      ///
+      /// where every x is one of the function's parameters. Other guards are evaluated from their parse tree.
+      /// The predicate also works out whether its answer follows from the parameter types alone, so that
+      /// Type_Guard_Function can remember it.
+      class Guard_Compiler
+      {
+        public:
+          typedef std::function<bool (const std::vector<Boxed_Value> &, bool &)> Condition;
+
+          /// \returns the guard for a function with parameters t_param_names and guard expression t_guard
+          static std::shared_ptr<dispatch::Dynamic_Proxy_Function> make_guard(chaiscript::detail::Dispatch_Engine &t_ss,
+              const AST_NodePtr &t_guard, const std::vector<std::string> &t_param_names)
+          {
+            const int arity = static_cast<int>(t_param_names.size());
+
+            Guard_Compiler compiler(t_ss, t_param_names);
+            const Condition condition = compiler.condition(t_guard);
+            const auto param_symbols = chaiscript::detail::to_symbols(t_param_names);
+
+            if (!condition)
+            {
+              return std::make_shared<dispatch::Dynamic_Proxy_Function>(
+                  [&t_ss, t_guard, param_symbols](const std::vector<Boxed_Value> &t_params)
+                  {
+                    return eval_function(t_ss, t_guard, param_symbols, t_params);
+                  }, arity, t_guard);
+            }
+
+            const auto builtins = std::make_shared<Builtins>(std::move(compiler.m_builtins));
+
+            return std::make_shared<dispatch::Type_Guard_Function>(
+                [&t_ss, t_guard, param_symbols, condition, builtins](const std::vector<Boxed_Value> &t_params, bool &t_types_only) -> bool
+                {
+                  if (builtins->unchanged(t_ss))
+                  {
+                    try {
+                      return condition(t_params, t_types_only);
+                    } catch (const Fallback &) {
+                    }
+                  }
+
+                  t_types_only = false;
+                  return boxed_cast<bool>(eval_function(t_ss, t_guard, param_symbols, t_params));
+                },
+                [&t_ss]() { return t_ss.lookup_generation(); },
+                arity, t_guard);
+          }
+
+        private:
+          typedef std::function<Boxed_Value (const std::vector<Boxed_Value> &)> Lookup;
+
+          /// Thrown by a predicate that meets a case it does not handle like the interpreter would
+          struct Fallback
+          {
+          };
+
+          /// The engine functions a predicate stands in for. If a script defines an overload of one of
+          /// them the guard could dispatch differently, so it goes back to being interpreted.
+          struct Builtins
+          {
+            explicit Builtins(std::vector<std::string> t_names)
+              : names(std::move(t_names)), checked_generation(0), replaced(true)
+            {
+            }
+
+            bool unchanged(const chaiscript::detail::Dispatch_Engine &t_ss)
+            {
+              const size_t generation = t_ss.lookup_generation();
+              if (checked_generation != generation)
+              {
+                bool found_replacement = false;
+                for (const auto &name : names)
+                {
+                  const auto table = t_ss.get_dispatch_table(name);
+                  if (!table || std::any_of(table->functions().begin(), table->functions().end(),
+                        [](const Proxy_Function &t_func) {
+                          const auto dynamic = std::dynamic_pointer_cast<const dispatch::Dynamic_Proxy_Function>(t_func);
+                          return dynamic && dynamic->get_parse_tree();
+                        }))
+                  {
+                    found_replacement = true;
+                  }
+                }
+
+                replaced = found_replacement;
+                checked_generation = generation;
+              }
+
+              return !replaced;
+            }
+
+            const std::vector<std::string> names;
+            std::atomic<size_t> checked_generation;
+            std::atomic<bool> replaced;
+          };
+
+          Guard_Compiler(chaiscript::detail::Dispatch_Engine &t_ss, const std::vector<std::string> &t_param_names)
+            : m_ss(t_ss), m_param_names(t_param_names)
+          {
+          }
+
+          /// \returns the predicate for t_node, or an empty function if t_node is not supported
+          Condition condition(const AST_NodePtr &t_node)
+          {
+            switch (t_node->identifier)
+            {
+              case AST_Node_Type::Logical_And:
+              case AST_Node_Type::Logical_Or:
+                return junction(t_node);
+              case AST_Node_Type::Prefix:
+                return negation(t_node);
+              case AST_Node_Type::Fun_Call:
+                return call(t_node);
+              case AST_Node_Type::Dot_Access:
+                return method_call(t_node);
+              default:
+                return Condition();
+            }
+          }
+
+          Condition junction(const AST_NodePtr &t_node)
+          {
+            std::vector<Condition> operands;
+            for (size_t i = 0; i < t_node->children.size(); i += 2)
+            {
+              operands.push_back(condition(t_node->children[i]));
+              if (!operands.back()) {
+                return Condition();
+              }
+            }
+
+            // && stops at the first false operand and || at the first true one
+            const bool is_and = t_node->identifier == AST_Node_Type::Logical_And;
+            return [operands, is_and](const std::vector<Boxed_Value> &t_params, bool &t_types_only)
+            {
+              for (const auto &operand : operands)
+              {
+                if (operand(t_params, t_types_only) != is_and) {
+                  return !is_and;
+                }
+              }
+              return is_and;
+            };
+          }
+
+          Condition negation(const AST_NodePtr &t_node)
+          {
+            if (t_node->children.size() != 2 || t_node->children[0]->text != "!") {
+              return Condition();
+            }
+
+            const Condition operand = condition(t_node->children[1]);
+            if (!operand) {
+              return Condition();
+            }
+
+            return [operand](const std::vector<Boxed_Value> &t_params, bool &t_types_only)
+            {
+              return !operand(t_params, t_types_only);
+            };
+          }
+
+          Condition call(const AST_NodePtr &t_node)
+          {
+            std::vector<AST_NodePtr> args;
+            const std::string name = function_name(t_node, args);
+
+            if (name == "call_exists" && !args.empty())
+            {
+              const Lookup lookup = function_lookup(args[0]);
+              std::vector<size_t> indices;
+              for (size_t i = 1; i < args.size(); ++i)
+              {
+                indices.push_back(param_index(args[i]));
+                if (indices.back() == npos) {
+                  return Condition();
+                }
+              }
+
+              if (!lookup) {
+                return Condition();
+              }
+
+              use("call_exists");
+              auto &ss = m_ss;
+              return [&ss, lookup, indices](const std::vector<Boxed_Value> &t_params, bool &t_types_only)
+              {
+                std::vector<Boxed_Value> call_params;
+                call_params.reserve(indices.size());
+                for (const auto index : indices)
+                {
+                  call_params.push_back(t_params[index]);
+                }
+
+                return call_exists(ss, boxed_cast<Const_Proxy_Function>(lookup(t_params)), call_params, t_types_only);
+              };
+            } else if (name == "function_exists" && args.size() == 1) {
+              const size_t index = type_name_param(args[0]);
+              if (index == npos) {
+                return Condition();
+              }
+
+              use("function_exists");
+              auto &ss = m_ss;
+              return [&ss, index](const std::vector<Boxed_Value> &t_params, bool &)
+              {
+                return ss.function_exists(ss.type_name(t_params[index]));
+              };
+            } else if (name == "is_type" && args.size() == 2) {
+              return is_type(param_index(args[0]), args[1]);
+            }
+
+            return Condition();
+          }
+
+          /// Only `x.is_type("name")` is supported
+          Condition method_call(const AST_NodePtr &t_node)
+          {
+            if (t_node->children.size() != 3) {
+              return Condition();
+            }
+
+            std::vector<AST_NodePtr> args;
+            if (function_name(t_node->children[2], args) != "is_type" || args.size() != 1) {
+              return Condition();
+            }
+
+            return is_type(param_index(t_node->children[0]), args[0]);
+          }
+
+          Condition is_type(size_t t_index, const AST_NodePtr &t_type_name)
+          {
+            if (t_index == npos || t_type_name->identifier != AST_Node_Type::Quoted_String) {
+              return Condition();
+            }
+
+            use("is_type");
+            auto &ss = m_ss;
+            const std::string type_name = t_type_name->text;
+            return [&ss, t_index, type_name](const std::vector<Boxed_Value> &t_params, bool &)
+            {
+              return ss.is_type(t_params[t_index], type_name);
+            };
+          }
+
+          /// \returns a lookup of the function passed as the first argument of call_exists
+          Lookup function_lookup(const AST_NodePtr &t_node)
+          {
+            if (t_node->identifier == AST_Node_Type::Id && param_index(t_node) == npos)
+            {
+              // named functions are found the way the interpreter finds them
+              auto &ss = m_ss;
+              return [&ss, t_node](const std::vector<Boxed_Value> &) { return t_node->eval(ss); };
+            }
+
+            std::vector<AST_NodePtr> args;
+            if (function_name(t_node, args) == "eval" && args.size() == 1)
+            {
+              const size_t index = type_name_param(args[0]);
+              if (index == npos) {
+                return Lookup();
+              }
+
+              use("eval");
+              auto &ss = m_ss;
+              return [&ss, index](const std::vector<Boxed_Value> &t_params)
+              {
+                // evaluating the name of a function returns that function, anything else is parsed
+                const std::string name = ss.type_name(t_params[index]);
+                if (!ss.function_exists(name)) {
+                  throw Fallback();
+                }
+                return ss.get_object(name);
+              };
+            }
+
+            return Lookup();
+          }
+
+          /// \returns the index of the parameter passed to `type_name(x)`, or npos
+          size_t type_name_param(const AST_NodePtr &t_node)
+          {
+            std::vector<AST_NodePtr> args;
+            if (function_name(t_node, args) != "type_name" || args.size() != 1) {
+              return npos;
+            }
+
+            use("type_name");
+            return param_index(args[0]);
+          }
+
+          /// \returns the index of the parameter t_node names, or npos
+          size_t param_index(const AST_NodePtr &t_node) const
+          {
+            if (t_node->identifier == AST_Node_Type::Id)
+            {
+              const auto itr = std::find(m_param_names.begin(), m_param_names.end(), t_node->text);
+              if (itr != m_param_names.end()) {
+                return static_cast<size_t>(itr - m_param_names.begin());
+              }
+            }
+
+            return npos;
+          }
+
+          /// \returns the name of the function t_node calls and fills t_args with its arguments,
+          ///          or returns an empty string if t_node is not a call of a named function
+          static std::string function_name(const AST_NodePtr &t_node, std::vector<AST_NodePtr> &t_args)
+          {
+            if (t_node->identifier != AST_Node_Type::Fun_Call || t_node->children.size() != 2
+                || t_node->children[0]->identifier != AST_Node_Type::Id
+                || t_node->children[1]->identifier != AST_Node_Type::Arg_List)
+            {
+              return std::string();
+            }
+
+            t_args = t_node->children[1]->children;
+            return t_node->children[0]->text;
+          }
+
+          void use(const std::string &t_builtin)
+          {
+            if (std::find(m_builtins.begin(), m_builtins.end(), t_builtin) == m_builtins.end()) {
+              m_builtins.push_back(t_builtin);
+            }
+          }
+
+          /// Same as Dispatch_Engine::call_exists. A Dispatch_Function is tried one function at a time
+          /// to find out whether the functions that decided the answer were decided by types alone.
+          static bool call_exists(const chaiscript::detail::Dispatch_Engine &t_ss, const Const_Proxy_Function &t_func,
+              const std::vector<Boxed_Value> &t_params, bool &t_types_only)
+          {
+            const auto dispatch_fun = std::dynamic_pointer_cast<const chaiscript::detail::Dispatch_Function>(t_func);
+            if (!dispatch_fun)
+            {
+              const bool matched = t_func->call_match(t_params, t_ss.conversions());
+              t_types_only = t_types_only && depends_on_types(t_func, t_params);
+              return matched;
+            }
+
+            for (const auto &func : dispatch_fun->get_dispatch_table()->functions(t_params.size()))
+            {
+              const bool matched = func->call_match(t_params, t_ss.conversions());
+              t_types_only = t_types_only && depends_on_types(func, t_params);
+              if (matched) {
+                return true;
+              }
+            }
+
+            return false;
+          }
+
+          /// \returns true if t_func, having just been matched against t_params, would give the same
+          ///          answer for any parameters of the same types
+          static bool depends_on_types(const Const_Proxy_Function &t_func, const std::vector<Boxed_Value> &t_params)
+          {
+            const auto dynamic = std::dynamic_pointer_cast<const dispatch::Dynamic_Proxy_Function>(t_func);
+            if (dynamic && dynamic->get_guard())
+            {
+              const auto type_guard = std::dynamic_pointer_cast<const dispatch::Type_Guard_Function>(dynamic->get_guard());
+              if (!type_guard || !type_guard->is_memoized(t_params)) {
+                return false;
+              }
+            }
+
+            return dispatch::Dispatch_Table::is_cacheable(t_func->get_contained_functions(), t_params);
+          }
+
+          static const size_t npos = static_cast<size_t>(-1);
+
+          chaiscript::detail::Dispatch_Engine &m_ss;
+          const std::vector<std::string> &m_param_names;
+          std::vector<std::string> m_builtins;
+      };
     }
 
     struct Binary_Operator_AST_Node : public AST_Node {
       public:
         Binary_Operator_AST_Node(const std::string &t_oper) :
           AST_Node(t_oper, AST_Node_Type::Binary, std::make_shared<std::string>(""), 0, 0, 0, 0),
-          m_oper(Operators::to_operator(t_oper))
+          m_oper(Operators::to_operator(t_oper)),
+          m_oper_symbol(t_oper),
+          m_feedback(is_specialisable(m_oper) ? Unseen : Generic)
       { }
 
         virtual ~Binary_Operator_AST_Node() {}
@@ -85,25 +537,39 @@ namespace chaiscript
         Boxed_Value do_oper(chaiscript::detail::Dispatch_Engine &t_ss, 
             Operators::Opers t_oper, const std::string &t_oper_string, const Boxed_Value &t_lhs, const Boxed_Value &t_rhs) const
         {
+          // Arithmetic on numbers does not call any script function, so it skips the function
+          // call bookkeeping and parameter saving that dispatch needs
+          if (t_oper == m_oper)
+          {
+            switch (specialisation(t_lhs, t_rhs))
+            {
+              case Int_Int:
+                return go(m_oper, unboxed<int>(t_lhs), unboxed<int>(t_rhs));
+              case Double_Double:
+                return go(m_oper, unboxed<double>(t_lhs), unboxed<double>(t_rhs));
+              default:
+                break;
+            }
+          }
+
+          if (t_oper != Operators::invalid && t_lhs.get_type_info().is_arithmetic() && t_rhs.get_type_info().is_arithmetic())
+          {
+            // If it's an arithmetic operation we want to short circuit dispatch
+            try{
+              return Boxed_Number::do_oper(t_oper, t_lhs, t_rhs);
+            } catch (const chaiscript::exception::arithmetic_error &) {
+              throw;
+            } catch (...) {
+              throw exception::eval_error("Error with numeric operator calling: " + t_oper_string);
+            }
+          }
+
           try {
             chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
             fpp.save_params({t_lhs, t_rhs});
 
-            if (t_oper != Operators::invalid && t_lhs.get_type_info().is_arithmetic() && t_rhs.get_type_info().is_arithmetic())
-            {
-              // If it's an arithmetic operation we want to short circuit dispatch
-              try{
-                return Boxed_Number::do_oper(t_oper, t_lhs, t_rhs);
-              } catch (const chaiscript::exception::arithmetic_error &) {
-                throw;
-              } catch (...) {
-                throw exception::eval_error("Error with numeric operator calling: " + t_oper_string);
-              }
-
-            } else {
-              chaiscript::eval::detail::Stack_Push_Pop spp(t_ss);
-              return t_ss.call_function(t_oper_string, t_lhs, t_rhs);
-            }
+            chaiscript::eval::detail::Stack_Push_Pop spp(t_ss);
+            return t_ss.call_function(m_oper_symbol, t_lhs, t_rhs);
           }
           catch(const exception::dispatch_error &e){
             throw exception::eval_error("Can not find appropriate '" + t_oper_string + "' operator.", e.parameters, e.functions, false, t_ss);
@@ -111,7 +577,110 @@ namespace chaiscript
         }
 
       private:
+        /// Operand types this node has seen. The first evaluation picks int/int, double/double or
+        /// Generic, and any later mismatch drops the node to Generic for good.
+        enum Feedback { Unseen, Int_Int, Double_Double, Generic };
+
+        static bool is_specialisable(Operators::Opers t_oper)
+        {
+          switch (t_oper)
+          {
+            case Operators::equals:
+            case Operators::less_than:
+            case Operators::greater_than:
+            case Operators::less_than_equal:
+            case Operators::greater_than_equal:
+            case Operators::not_equal:
+            case Operators::remainder:
+            case Operators::sum:
+            case Operators::quotient:
+            case Operators::product:
+            case Operators::difference:
+              return true;
+            default:
+              return false;
+          }
+        }
+
+        template<typename T>
+          static const T &unboxed(const Boxed_Value &t_bv)
+          {
+            return *static_cast<const T *>(t_bv.get_const_ptr());
+          }
+
+        template<typename T>
+          static Boxed_Value go(Operators::Opers t_oper, const T &t, const T &u)
+          {
+            switch (t_oper)
+            {
+              case Operators::equals:
+                return const_var(t == u);
+              case Operators::less_than:
+                return const_var(t < u);
+              case Operators::greater_than:
+                return const_var(t > u);
+              case Operators::less_than_equal:
+                return const_var(t <= u);
+              case Operators::greater_than_equal:
+                return const_var(t >= u);
+              case Operators::not_equal:
+                return const_var(t != u);
+              case Operators::sum:
+                return const_var(t + u);
+              case Operators::quotient:
+                Boxed_Number::check_divide_by_zero(u);
+                return const_var(t / u);
+              case Operators::product:
+                return const_var(t * u);
+              case Operators::difference:
+                return const_var(t - u);
+              default:
+                throw chaiscript::detail::exception::bad_any_cast();
+            }
+          }
+
+        static Boxed_Value go(Operators::Opers t_oper, const int &t, const int &u)
+        {
+          if (t_oper == Operators::remainder)
+          {
+            Boxed_Number::check_divide_by_zero(u);
+            return const_var(t % u);
+          }
+
+          return go<int>(t_oper, t, u);
+        }
+
+        /// Returns the specialisation that applies to these operands, recording the operand
+        /// types on first use. Returns Generic, and stops specialising, once the types change.
+        Feedback specialisation(const Boxed_Value &t_lhs, const Boxed_Value &t_rhs) const
+        {
+          const Feedback feedback = m_feedback.load(std::memory_order_relaxed);
+          if (feedback == Generic) {
+            return Generic;
+          }
+
+          const Type_Info &lhs_type = t_lhs.get_type_info();
+          const Type_Info &rhs_type = t_rhs.get_type_info();
+
+          Feedback seen = Generic;
+          if (lhs_type.bare_equal_type_info(typeid(int)) && rhs_type.bare_equal_type_info(typeid(int))) {
+            seen = Int_Int;
+          } else if (m_oper != Operators::remainder
+              && lhs_type.bare_equal_type_info(typeid(double)) && rhs_type.bare_equal_type_info(typeid(double))) {
+            seen = Double_Double;
+          }
+
+          if (feedback != seen) {
+            m_feedback.store(feedback == Unseen ? seen : Generic, std::memory_order_relaxed);
+            return feedback == Unseen ? seen : Generic;
+          }
+
+          return seen;
+        }
+
         Operators::Opers m_oper;
+        chaiscript::detail::Symbol m_oper_symbol;
+        mutable std::atomic<Feedback> m_feedback;
     };
 
     struct Int_AST_Node : public AST_Node {
@@ -148,7 +717,8 @@ namespace chaiscript
       public:
         Id_AST_Node(const std::string &t_ast_node_text, const std::shared_ptr<std::string> &t_fname, int t_start_line, int t_start_col, int t_end_line, int t_end_col) :
           AST_Node(t_ast_node_text, AST_Node_Type::Id, t_fname, t_start_line, t_start_col, t_end_line, t_end_col),
-          m_value(get_value(t_ast_node_text))
+          m_value(get_value(t_ast_node_text)),
+          m_symbol(t_ast_node_text)
       { }
 
         virtual ~Id_AST_Node() {}
@@ -158,7 +728,7 @@ namespace chaiscript
             return m_value;
           } else {
             try {
-              return t_ss.get_object(this->text);
+              return t_ss.get_object(m_symbol, m_loc);
             }
             catch (std::exception &) {
               throw exception::eval_error("Can not find object: " + this->text);
@@ -166,6 +736,22 @@ namespace chaiscript
           }
         }
 
+        /// \returns The interned name of this identifier
+        const chaiscript::detail::Symbol &symbol() const
+        {
+          return m_symbol;
+        }
+
+        /// \returns The symbol of the name in t_node, interning it if t_node is not an Id_AST_Node
+        static chaiscript::detail::Symbol symbol_of(const AST_NodePtr &t_node)
+        {
+          if (const auto *id = dynamic_cast<const Id_AST_Node *>(t_node.get())) {
+            return id->symbol();
+          } else {
+            return chaiscript::detail::Symbol(t_node->text);
+          }
+        }
+
       private:
         static Boxed_Value get_value(const std::string &t_text)
         {
@@ -181,11 +767,15 @@ namespace chaiscript
           else if (t_text == "NaN") {
             return const_var(std::numeric_limits<double>::quiet_NaN());
           } else {
-            return Boxed_Value();
+            // never handed out, so every plain identifier can share one
+            static const Boxed_Value undef;
+            return undef;
           }
         }
 
         Boxed_Value m_value;
+        chaiscript::detail::Symbol m_symbol;
+        mutable chaiscript::detail::Object_Location m_loc;
     };
 
     struct Char_AST_Node : public AST_Node {
@@ -239,7 +829,16 @@ namespace chaiscript
 
           try {
             chaiscript::eval::detail::Stack_Push_Pop spp(t_ss);
-            return (*t_ss.boxed_cast<const Const_Proxy_Function &>(fn))(params, t_ss.conversions());
+            const Const_Proxy_Function &f = t_ss.boxed_cast<const Const_Proxy_Function &>(fn);
+            const auto *dispatch_fun = dynamic_cast<const chaiscript::detail::Dispatch_Function *>(f.get());
+            if (!dispatch_fun)
+            {
+              return (*f)(params, t_ss.conversions());
+            }
+
+            // overloaded function, the Dispatch_Function is immutable so it serves as the cache key
+            return detail::cached_dispatch(t_ss, m_cache, f, params, 
+                [dispatch_fun]() { return dispatch_fun->get_dispatch_table(); });
           }
           catch(const exception::dispatch_error &e){
             throw exception::eval_error(std::string(e.what()) + " with function '" + this->children[0]->text + "'", e.parameters, e.functions, false, t_ss);
@@ -259,9 +858,6 @@ namespace chaiscript
           catch(const exception::guard_error &e){
             throw exception::eval_error(std::string(e.what()) + " with function '" + this->children[0]->text + "'");
           }
-          catch(detail::Return_Value &rv) {
-            return rv.retval;
-          }
         }
 
         virtual std::string pretty_print() const CHAISCRIPT_OVERRIDE 
@@ -284,6 +880,8 @@ namespace chaiscript
           return oss.str();
         }
 
+      private:
+        mutable dispatch::Call_Site_Cache m_cache;
     };
 
     /// Used in the context of in-string ${} evals, so that no new scope is created
@@ -326,9 +924,6 @@ namespace chaiscript
           catch(const exception::guard_error &e){
             throw exception::eval_error(std::string(e.what()) + " with function '" + this->children[0]->text + "'");
           }
-          catch(detail::Return_Value &rv) {
-            return rv.retval;
-          }
         }
 
         virtual std::string pretty_print() const CHAISCRIPT_OVERRIDE 
@@ -528,7 +1123,7 @@ namespace chaiscript
 
             Boxed_Value bv;
             try {
-              t_ss.add_object(idname, bv);
+              t_ss.add_object(Id_AST_Node::symbol_of(this->children[0]), bv);
             }
             catch (const exception::reserved_word_error &) {
               throw exception::eval_error("Reserved word used as variable '" + idname + "'");
@@ -604,6 +1199,19 @@ namespace chaiscript
 
           if (this->children.size() > 1) {
             for (size_t i = 2; i < this->children.size(); i+=2) {
+              // the attribute cache only holds names without guarded overloads, so which function
+              // reads the attribute changes only with the functions and conversions registered
+              const size_t generation = t_ss.dispatch_generation();
+
+              // `obj.name` on a script object may read an attribute the cache knows the slot of
+              const bool is_attr_read = this->children[i]->identifier == AST_Node_Type::Id
+                && retval.get_type_info().bare_equal(user_type<dispatch::Dynamic_Object>()) && !retval.is_const();
+              if (is_attr_read
+                  && m_attr_cache.find(this->children[i].get(), generation, boxed_cast<dispatch::Dynamic_Object &>(retval), retval))
+              {
+                continue;
+              }
+
               std::vector<Boxed_Value> params{retval};
 
               if (this->children[i]->children.size() > 1) {
@@ -622,9 +1230,11 @@ namespace chaiscript
                 fun_name = this->children[i]->text;
               }
 
+              Const_Proxy_Function matched;
               try {
                 chaiscript::eval::detail::Stack_Push_Pop spp(t_ss);
-                retval = t_ss.call_function(fun_name, std::move(params));
+                retval = detail::cached_dispatch(t_ss, m_cache, this->children[i], params, 
+                    [&t_ss, &fun_name]() { return t_ss.get_dispatch_table(fun_name); }, &matched);
               }
               catch(const exception::dispatch_error &e){
                 if (e.functions.empty())
@@ -634,8 +1244,9 @@ namespace chaiscript
                   throw exception::eval_error(std::string(e.what()) + " for function '" + fun_name + "'", e.parameters, e.functions, true, t_ss);
                 }
               }
-              catch(detail::Return_Value &rv) {
-                retval = rv.retval;
+
+              if (is_attr_read && matched) {
+                remember_attribute(t_ss, generation, this->children[i].get(), fun_name, params[0], matched);
               }
 
               if (this->children[i]->identifier == AST_Node_Type::Array_Call) {
@@ -654,6 +1265,30 @@ namespace chaiscript
           return retval;
         }
 
+      private:
+        /// Caches the slot t_matched read from t_obj, if it is an attribute and no other function
+        /// named t_name could have been chosen for a different object of the same class
+        void remember_attribute(const chaiscript::detail::Dispatch_Engine &t_ss, size_t t_generation, const void *t_site,
+            const std::string &t_name, const Boxed_Value &t_obj, const Const_Proxy_Function &t_matched) const
+        {
+          if (!dynamic_cast<const dispatch::detail::Dynamic_Object_Function *>(t_matched.get())) {
+            return;
+          }
+
+          const auto contained = t_matched->get_contained_functions();
+          const auto attr = contained.size() == 1
+            ? std::dynamic_pointer_cast<const dispatch::detail::Dynamic_Object_Attribute>(contained[0])
+            : std::shared_ptr<const dispatch::detail::Dynamic_Object_Attribute>();
+          const auto table = t_ss.get_dispatch_table(t_name);
+
+          if (attr && table && table->is_unguarded())
+          {
+            m_attr_cache.insert(t_site, t_generation, boxed_cast<const dispatch::Dynamic_Object &>(t_obj), *attr);
+          }
+        }
+
+        mutable dispatch::Call_Site_Cache m_cache;
+        mutable dispatch::detail::Attribute_Cache m_attr_cache;
     };
 
     struct Quoted_String_AST_Node : public AST_Node {
@@ -704,7 +1339,7 @@ namespace chaiscript
         virtual ~Lambda_AST_Node() {}
 
         virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &t_ss) const CHAISCRIPT_OVERRIDE{
-          std::vector<std::string> t_param_names;
+          std::vector<chaiscript::detail::Symbol> t_param_names;
 
           size_t numparams = 0;
 
@@ -712,7 +1347,7 @@ namespace chaiscript
 
           if (!this->children.empty() && (this->children[0]->identifier == AST_Node_Type::Arg_List)) {
             numparams = this->children[0]->children.size();
-            t_param_names = Arg_List_AST_Node::get_arg_names(this->children[0]);
+            t_param_names = chaiscript::detail::to_symbols(Arg_List_AST_Node::get_arg_names(this->children[0]));
             param_types = Arg_List_AST_Node::get_arg_types(this->children[0], t_ss);
           }
 
@@ -738,18 +1373,18 @@ namespace chaiscript
           const auto num_children = this->children.size();
 
           chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
+          const auto &flow = t_ss.get_control_flow();
 
           for (size_t i = 0; i < num_children; ++i) {
-            try {
-              if (i + 1 < num_children)
-              {
-                this->children[i]->eval(t_ss);
-              } else {
-                return this->children[i]->eval(t_ss);
+            if (i + 1 < num_children)
+            {
+              this->children[i]->eval(t_ss);
+              if (flow.pending()) {
+                // the rest of the block is skipped by a return, break or continue
+                return Boxed_Value();
               }
-            }
-            catch (const chaiscript::eval::detail::Return_Value &) {
-              throw;
+            } else {
+              return this->children[i]->eval(t_ss);
             }
           }
 
@@ -789,21 +1424,19 @@ namespace chaiscript
 
           std::shared_ptr<dispatch::Dynamic_Proxy_Function> guard;
           if (guardnode) {
-            guard = std::shared_ptr<dispatch::Dynamic_Proxy_Function>
-              (new dispatch::Dynamic_Proxy_Function([&t_ss, guardnode, t_param_names](const std::vector<Boxed_Value> &t_params)
-                                                    {
-                                                      return detail::eval_function(t_ss, guardnode, t_param_names, t_params);
-                                                    }, static_cast<int>(numparams), guardnode));
+            guard = detail::Guard_Compiler::make_guard(t_ss, guardnode, t_param_names);
           }
 
+          const auto param_symbols = chaiscript::detail::to_symbols(t_param_names);
+
           try {
             const std::string & l_function_name = this->children[0]->text;
             const std::string & l_annotation = this->annotation?this->annotation->text:"";
             const auto & func_node = this->children.back();
             t_ss.add(Proxy_Function
-                (new dispatch::Dynamic_Proxy_Function([&t_ss, guardnode, func_node, t_param_names](const std::vector<Boxed_Value> &t_params)
+                (new dispatch::Dynamic_Proxy_Function([&t_ss, guardnode, func_node, param_symbols](const std::vector<Boxed_Value> &t_params)
                                                       {
-                                                        return detail::eval_function(t_ss, func_node, t_param_names, t_params);
+                                                        return detail::eval_function(t_ss, func_node, param_symbols, t_params);
                                                       }, static_cast<int>(numparams), this->children.back(),
                                                          param_types, l_annotation, guard)), l_function_name);
           }
@@ -824,21 +1457,28 @@ namespace chaiscript
         virtual ~While_AST_Node() {}
         virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &t_ss) const CHAISCRIPT_OVERRIDE {
           chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
+          auto &flow = t_ss.get_control_flow();
 
           try {
             while (boxed_cast<bool>(this->children[0]->eval(t_ss))) {
-              try {
-                this->children[1]->eval(t_ss);
-              } catch (detail::Continue_Loop &) {
-                // we got a continue exception, which means all of the remaining 
-                // loop implementation is skipped and we just need to continue to
-                // the next condition test
+              this->children[1]->eval(t_ss);
+
+              if (flow.pending()) {
+                if (flow.type == chaiscript::detail::Control_Flow::Continue) {
+                  // the remaining loop implementation is skipped and we just 
+                  // need to continue to the next condition test
+                  flow.type = chaiscript::detail::Control_Flow::None;
+                } else {
+                  // loop was broken intentionally, or we are returning from the function
+                  if (flow.type == chaiscript::detail::Control_Flow::Break) {
+                    flow.type = chaiscript::detail::Control_Flow::None;
+                  }
+                  break;
+                }
               }
             } 
           } catch (const exception::bad_boxed_cast &) {
             throw exception::eval_error("While condition not boolean");
-          } catch (detail::Break_Loop &) {
-            // loop was broken intentionally
           }
 
           return Boxed_Value();
@@ -939,19 +1579,29 @@ namespace chaiscript
         virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &t_ss) const CHAISCRIPT_OVERRIDE{
           chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
 
+          auto &flow = t_ss.get_control_flow();
+
           // initial expression
           this->children[0]->eval(t_ss);
 
           try {
             // while condition evals to true
             while (boxed_cast<bool>(this->children[1]->eval(t_ss))) {
-              try {
-                // Body of Loop
-                this->children[3]->eval(t_ss);
-              } catch (detail::Continue_Loop &) {
-                // we got a continue exception, which means all of the remaining 
-                // loop implementation is skipped and we just need to continue to
-                // the next iteration step
+              // Body of Loop
+              this->children[3]->eval(t_ss);
+
+              if (flow.pending()) {
+                if (flow.type == chaiscript::detail::Control_Flow::Continue) {
+                  // the remaining loop implementation is skipped and we just 
+                  // need to continue to the next iteration step
+                  flow.type = chaiscript::detail::Control_Flow::None;
+                } else {
+                  // loop broken, or we are returning from the function
+                  if (flow.type == chaiscript::detail::Control_Flow::Break) {
+                    flow.type = chaiscript::detail::Control_Flow::None;
+                  }
+                  break;
+                }
               }
 
               // loop expression
@@ -961,9 +1611,6 @@ namespace chaiscript
           catch (const exception::bad_boxed_cast &) {
             throw exception::eval_error("For condition not boolean");
           }
-          catch (detail::Break_Loop &) {
-            // loop broken
-          }
 
           return Boxed_Value();
         }
@@ -981,29 +1628,33 @@ namespace chaiscript
           bool hasMatched = false;
 
           chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
+          auto &flow = t_ss.get_control_flow();
 
           Boxed_Value match_value(this->children[0]->eval(t_ss));
 
           while (!breaking && (currentCase < this->children.size())) {
-            try {
-              if (this->children[currentCase]->identifier == AST_Node_Type::Case) {
-                //This is a little odd, but because want to see both the switch and the case simultaneously, I do a downcast here.
-                try {
-                  if (hasMatched || boxed_cast<bool>(t_ss.call_function("==", match_value, this->children[currentCase]->children[0]->eval(t_ss)))) {
-                    this->children[currentCase]->eval(t_ss);
-                    hasMatched = true;
-                  }
-                }
-                catch (const exception::bad_boxed_cast &) {
-                  throw exception::eval_error("Internal error: case guard evaluation not boolean");
+            if (this->children[currentCase]->identifier == AST_Node_Type::Case) {
+              //This is a little odd, but because want to see both the switch and the case simultaneously, I do a downcast here.
+              try {
+                if (hasMatched || boxed_cast<bool>(t_ss.call_function("==", match_value, this->children[currentCase]->children[0]->eval(t_ss)))) {
+                  this->children[currentCase]->eval(t_ss);
+                  hasMatched = true;
                 }
               }
-              else if (this->children[currentCase]->identifier == AST_Node_Type::Default) {
-                this->children[currentCase]->eval(t_ss);
-                breaking = true;
+              catch (const exception::bad_boxed_cast &) {
+                throw exception::eval_error("Internal error: case guard evaluation not boolean");
               }
             }
-            catch (detail::Break_Loop &) {
+            else if (this->children[currentCase]->identifier == AST_Node_Type::Default) {
+              this->children[currentCase]->eval(t_ss);
+              breaking = true;
+            }
+
+            if (flow.pending()) {
+              // a break ends the switch, a continue or return is left for the enclosing loop or function
+              if (flow.type == chaiscript::detail::Control_Flow::Break) {
+                flow.type = chaiscript::detail::Control_Flow::None;
+              }
               breaking = true;
             }
             ++currentCase;
@@ -1050,6 +1701,7 @@ namespace chaiscript
           try {
             std::vector<Boxed_Value> vec;
             if (!this->children.empty()) {
+              vec.reserve(this->children[0]->children.size());
               for (const auto &child : this->children[0]->children) {
                 vec.push_back(t_ss.call_function("clone", child->eval(t_ss)));
               }
@@ -1097,12 +1749,15 @@ namespace chaiscript
           AST_Node(std::move(t_ast_node_text), AST_Node_Type::Return, t_fname, t_start_line, t_start_col, t_end_line, t_end_col) { }
         virtual ~Return_AST_Node() {}
         virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &t_ss) const CHAISCRIPT_OVERRIDE{
+          Boxed_Value retval;
           if (!this->children.empty()) {
-            throw detail::Return_Value(this->children[0]->eval(t_ss));
-          }
-          else {
-            throw detail::Return_Value(Boxed_Value());
+            retval = this->children[0]->eval(t_ss);
           }
+
+          auto &flow = t_ss.get_control_flow();
+          flow.type = chaiscript::detail::Control_Flow::Return;
+          flow.retval = retval;
+          return retval;
         }
 
     };
@@ -1113,10 +1768,11 @@ namespace chaiscript
           AST_Node(std::move(t_ast_node_text), AST_Node_Type::File, t_fname, t_start_line, t_start_col, t_end_line, t_end_col) { }
         virtual ~File_AST_Node() {}
         virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &t_ss) const CHAISCRIPT_OVERRIDE {
+          const auto &flow = t_ss.get_control_flow();
           const size_t size = this->children.size(); 
           for (size_t i = 0; i < size; ++i) {
             Boxed_Value retval(this->children[i]->eval(t_ss));
-            if (i + 1 == size) {
+            if (i + 1 == size || flow.pending()) {
               return retval;
             }
           }
@@ -1133,7 +1789,7 @@ namespace chaiscript
         virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &t_ss) const CHAISCRIPT_OVERRIDE{
           try {
             Boxed_Value bv;
-            t_ss.add_object(this->children[0]->text, bv);
+            t_ss.add_object(Id_AST_Node::symbol_of(this->children[0]), bv);
             return bv;
           }
           catch (const exception::reserved_word_error &) {
@@ -1153,6 +1809,8 @@ namespace chaiscript
 
         virtual ~Prefix_AST_Node() {}
         virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &t_ss) const CHAISCRIPT_OVERRIDE{
+          // the operand is evaluated inside the call, so that whatever its evaluation saves
+          // stays alive until the operator has been applied to it
           chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
           Boxed_Value bv(this->children[1]->eval(t_ss));
 
@@ -1171,6 +1829,11 @@ namespace chaiscript
           }
         }
 
+        Operators::Opers get_oper() const
+        {
+          return m_oper;
+        }
+
       private:
         Operators::Opers m_oper;
     };
@@ -1180,8 +1843,9 @@ namespace chaiscript
         Break_AST_Node(const std::string &t_ast_node_text = "", const std::shared_ptr<std::string> &t_fname=std::shared_ptr<std::string>(), int t_start_line = 0, int t_start_col = 0, int t_end_line = 0, int t_end_col = 0) :
           AST_Node(t_ast_node_text, AST_Node_Type::Break, t_fname, t_start_line, t_start_col, t_end_line, t_end_col) { }
         virtual ~Break_AST_Node() {}
-        virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &) const CHAISCRIPT_OVERRIDE{
-          throw detail::Break_Loop();
+        virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &t_ss) const CHAISCRIPT_OVERRIDE{
+          t_ss.get_control_flow().type = chaiscript::detail::Control_Flow::Break;
+          return Boxed_Value();
         }
     };
 
@@ -1190,8 +1854,9 @@ namespace chaiscript
         Continue_AST_Node(const std::string &t_ast_node_text = "", const std::shared_ptr<std::string> &t_fname=std::shared_ptr<std::string>(), int t_start_line = 0, int t_start_col = 0, int t_end_line = 0, int t_end_col = 0) :
           AST_Node(t_ast_node_text, AST_Node_Type::Continue, t_fname, t_start_line, t_start_col, t_end_line, t_end_col) { }
         virtual ~Continue_AST_Node() {}
-        virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &) const CHAISCRIPT_OVERRIDE{
-          throw detail::Continue_Loop();
+        virtual Boxed_Value eval_internal(chaiscript::detail::Dispatch_Engine &t_ss) const CHAISCRIPT_OVERRIDE{
+          t_ss.get_control_flow().type = chaiscript::detail::Control_Flow::Continue;
+          return Boxed_Value();
         }
     };
 
@@ -1349,7 +2014,17 @@ namespace chaiscript
 
 
           if (this->children.back()->identifier == AST_Node_Type::Finally) {
+            // the finally block runs to completion even if the try or catch block returned,
+            // after which that return, break or continue resumes unless finally started its own
+            auto &flow = t_ss.get_control_flow();
+            chaiscript::detail::Control_Flow pending;
+            std::swap(pending, flow);
+
             retval = this->children.back()->children[0]->eval(t_ss);
+
+            if (!flow.pending()) {
+              std::swap(pending, flow);
+            }
           }
 
           return retval;
@@ -1410,12 +2085,11 @@ namespace chaiscript
 
           std::shared_ptr<dispatch::Dynamic_Proxy_Function> guard;
           if (guardnode) {
-            guard = std::make_shared<dispatch::Dynamic_Proxy_Function>
-              (std::bind(chaiscript::eval::detail::eval_function,
-                         std::ref(t_ss), guardnode,
-                         t_param_names, std::placeholders::_1), static_cast<int>(numparams), guardnode);
+            guard = detail::Guard_Compiler::make_guard(t_ss, guardnode, t_param_names);
           }
 
+          const auto param_symbols = chaiscript::detail::to_symbols(t_param_names);
+
           try {
             const std::string & l_annotation = this->annotation?this->annotation->text:"";
 
@@ -1423,8 +2097,9 @@ namespace chaiscript
 
             if (function_name == class_name) {
               param_types.push_front(class_name, Type_Info());
-              t_ss.add(std::make_shared<dispatch::detail::Dynamic_Object_Constructor>(class_name, std::make_shared<dispatch::Dynamic_Proxy_Function>(std::bind(chaiscript::eval::detail::eval_function,
-                        std::ref(t_ss), this->children.back(), t_param_names, std::placeholders::_1), 
+              t_ss.add(std::make_shared<dispatch::detail::Dynamic_Object_Constructor>(class_name, t_ss.get_object_shape(class_name),
+                    std::make_shared<dispatch::Dynamic_Proxy_Function>(std::bind(chaiscript::eval::detail::eval_function,
+                        std::ref(t_ss), this->children.back(), param_symbols, std::placeholders::_1), 
                       static_cast<int>(numparams), this->children.back(), param_types, l_annotation, guard)), 
                   function_name);
 
@@ -1440,7 +2115,7 @@ namespace chaiscript
                     std::make_shared<dispatch::detail::Dynamic_Object_Function>(class_name, 
                       std::make_shared<dispatch::Dynamic_Proxy_Function>(std::bind(chaiscript::eval::detail::eval_function,
                                                                          std::ref(t_ss), this->children.back(),
-                                                                         t_param_names, std::placeholders::_1), static_cast<int>(numparams), this->children.back(),
+                                                                         param_symbols, std::placeholders::_1), static_cast<int>(numparams), this->children.back(),
                                                                param_types, l_annotation, guard), type), function_name);
               } catch (const std::range_error &) {
                 param_types.push_front(class_name, Type_Info());
@@ -1449,7 +2124,7 @@ namespace chaiscript
                     std::make_shared<dispatch::detail::Dynamic_Object_Function>(class_name, 
                          std::make_shared<dispatch::Dynamic_Proxy_Function>(std::bind(chaiscript::eval::detail::eval_function,
                                                                          std::ref(t_ss), this->children.back(),
-                                                                         t_param_names, std::placeholders::_1), static_cast<int>(numparams), this->children.back(),
+                                                                         param_symbols, std::placeholders::_1), static_cast<int>(numparams), this->children.back(),
                                                                param_types, l_annotation, guard)), function_name);
               }
             }
@@ -1479,12 +2154,9 @@ namespace chaiscript
           try {
             t_ss.add(
                 std::make_shared<dispatch::detail::Dynamic_Object_Function>(
-                     std::move(class_name),
-                     fun(std::function<Boxed_Value (dispatch::Dynamic_Object &)>(std::bind(&dispatch::Dynamic_Object::get_attr, 
-                                                                                   std::placeholders::_1,
-                                                                                   this->children[static_cast<size_t>(1 + class_offset)]->text
-                                                                                   ))
-                     )
+                     class_name,
+                     std::make_shared<dispatch::detail::Dynamic_Object_Attribute>(this->children[static_cast<size_t>(1 + class_offset)]->text,
+                                                                                  t_ss.get_object_shape(class_name))
                 ), this->children[static_cast<size_t>(1 + class_offset)]->text);
 
           }
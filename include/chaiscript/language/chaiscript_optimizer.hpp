@@ -0,0 +1,208 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2015, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+#ifndef CHAISCRIPT_OPTIMIZER_HPP_
+#define CHAISCRIPT_OPTIMIZER_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../dispatchkit/boxed_number.hpp"
+#include "../dispatchkit/boxed_value.hpp"
+#include "../dispatchkit/dispatchkit.hpp"
+#include "chaiscript_algebraic.hpp"
+#include "chaiscript_common.hpp"
+#include "chaiscript_eval.hpp"
+
+namespace chaiscript
+{
+  /// \brief Classes and functions used to simplify a parsed AST before it is evaluated
+  namespace optimizer
+  {
+    /// \brief Rewrites a freshly parsed AST into an equivalent one that is cheaper to evaluate
+    ///
+    /// - Numeric expressions whose operands are all numeric literals are folded into a single
+    ///   literal. Only built in arithmetic is folded; operators on other types, such as `+` on
+    ///   strings or `!` on bools, may be overloaded by the user and are left to dispatch.
+    /// - Noop statements that do not provide the value of their block are dropped
+    /// - Blocks holding a single statement that declares nothing are replaced by that statement
+    ///
+    /// The tree is modified in place, so it must not be shared with anything else yet.
+    class Optimizer
+    {
+      public:
+        explicit Optimizer(chaiscript::detail::Dispatch_Engine &t_engine)
+          : m_engine(t_engine)
+        {
+        }
+
+        /// Returns the optimized replacement for t_node, which may be t_node itself
+        AST_NodePtr optimize(const AST_NodePtr &t_node) const
+        {
+          for (auto &child : t_node->children)
+          {
+            child = optimize(child);
+          }
+
+          switch (t_node->identifier)
+          {
+            case AST_Node_Type::Binary:
+              return fold_binary(t_node);
+            case AST_Node_Type::Prefix:
+              return fold_prefix(t_node);
+            case AST_Node_Type::File:
+              drop_noops(t_node);
+              return t_node;
+            case AST_Node_Type::Block:
+              drop_noops(t_node);
+              return collapse_block(t_node);
+            default:
+              return t_node;
+          }
+        }
+
+      private:
+        static bool is_number(const AST_NodePtr &t_node)
+        {
+          return t_node->identifier == AST_Node_Type::Int || t_node->identifier == AST_Node_Type::Float;
+        }
+
+        /// Only binary operators that leave their operands untouched can be folded
+        static bool is_foldable(Operators::Opers t_oper)
+        {
+          return (t_oper > Operators::boolean_flag && t_oper < Operators::non_const_flag)
+            || (t_oper > Operators::const_int_flag && t_oper < Operators::invalid && t_oper != Operators::const_flag);
+        }
+
+        /// Builds the literal node for a folded value, carrying over the position of the
+        /// expression it replaces
+        static AST_NodePtr make_literal(const AST_NodePtr &t_original, const Boxed_Value &t_value)
+        {
+          AST_NodePtr literal;
+          const Type_Info &type = t_value.get_type_info();
+
+          if (type.bare_equal(user_type<bool>())) {
+            literal = std::make_shared<eval::Id_AST_Node>(boxed_cast<bool>(t_value) ? "true" : "false",
+                std::shared_ptr<std::string>(), 0, 0, 0, 0);
+          } else if (type.bare_equal(user_type<double>()) || type.bare_equal(user_type<float>())
+              || type.bare_equal(user_type<long double>())) {
+            literal = std::make_shared<eval::Float_AST_Node>(Boxed_Number(t_value).to_string(), t_value,
+                std::shared_ptr<std::string>(), 0, 0, 0, 0);
+          } else {
+            literal = std::make_shared<eval::Int_AST_Node>(Boxed_Number(t_value).to_string(), t_value,
+                std::shared_ptr<std::string>(), 0, 0, 0, 0);
+          }
+
+          literal->filename = t_original->filename;
+          literal->start = t_original->start;
+          literal->end = t_original->end;
+          return literal;
+        }
+
+        AST_NodePtr fold_binary(const AST_NodePtr &t_node) const
+        {
+          const AST_NodePtr &lhs = t_node->children[0];
+          const AST_NodePtr &rhs = t_node->children[1];
+
+          if (is_number(lhs) && is_number(rhs))
+          {
+            const Operators::Opers oper = Operators::to_operator(t_node->text);
+            if (is_foldable(oper))
+            {
+              try {
+                return make_literal(t_node, Boxed_Number::do_oper(oper, lhs->eval(m_engine), rhs->eval(m_engine)));
+              } catch (...) {
+                // errors such as a division by zero are left to be reported when the code runs
+              }
+            }
+          }
+
+          return t_node;
+        }
+
+        AST_NodePtr fold_prefix(const AST_NodePtr &t_node) const
+        {
+          const std::string &oper_text = t_node->children[0]->text;
+          const AST_NodePtr &operand = t_node->children[1];
+
+          if (is_number(operand)) {
+            const Operators::Opers oper = Operators::to_operator(oper_text, true);
+            if (oper == Operators::unary_minus || oper == Operators::unary_plus || oper == Operators::bitwise_complement)
+            {
+              try {
+                return make_literal(t_node, Boxed_Number::do_oper(oper, operand->eval(m_engine)));
+              } catch (...) {
+                // left to be reported when the code runs
+              }
+            }
+          }
+
+          return t_node;
+        }
+
+        /// Noops evaluate to true, so only the last statement of a block has to stay
+        static void drop_noops(const AST_NodePtr &t_node)
+        {
+          auto &children = t_node->children;
+          if (children.empty()) {
+            return;
+          }
+
+          std::vector<AST_NodePtr> kept;
+          kept.reserve(children.size());
+          for (size_t i = 0; i + 1 < children.size(); ++i)
+          {
+            if (children[i]->identifier != AST_Node_Type::Noop) {
+              kept.push_back(children[i]);
+            }
+          }
+          kept.push_back(children.back());
+          children.swap(kept);
+        }
+
+        /// True if evaluating t_node can add a name to the scope it runs in
+        static bool declares_in_scope(const AST_NodePtr &t_node)
+        {
+          switch (t_node->identifier)
+          {
+            case AST_Node_Type::Var_Decl:
+            case AST_Node_Type::Reference:
+            case AST_Node_Type::Class:
+              return true;
+            case AST_Node_Type::Block:
+            case AST_Node_Type::Def:
+            case AST_Node_Type::Lambda:
+            case AST_Node_Type::Method:
+              // these open their own scope, or only run their bodies later
+              return false;
+            default:
+              for (const auto &child : t_node->children)
+              {
+                if (declares_in_scope(child)) {
+                  return true;
+                }
+              }
+              return false;
+          }
+        }
+
+        static AST_NodePtr collapse_block(const AST_NodePtr &t_node)
+        {
+          if (t_node->children.size() == 1 && !declares_in_scope(t_node->children[0]))
+          {
+            return t_node->children[0];
+          }
+
+          return t_node;
+        }
+
+        chaiscript::detail::Dispatch_Engine &m_engine;
+    };
+  }
+}
+
+#endif
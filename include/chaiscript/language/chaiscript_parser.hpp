@@ -12,6 +12,7 @@
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -139,6 +140,50 @@ namespace chaiscript
       /// Parses a floating point value and returns a Boxed_Value representation of it
       static Boxed_Value buildFloat(const std::string &t_val);
 
+      /// Reads the digits of t_val before t_end in t_base, the way extracting it from a stream
+      /// would: a leading 0x is skipped for hex, reading stops at the first character that is
+      /// not a digit, and values too large for 64 bits saturate.
+      static uint64_t parse_digits(const std::string &t_val, size_t t_end, uint64_t t_base)
+      {
+        size_t i = 0;
+        if (t_base == 16 && t_end >= 2 && t_val[0] == '0' && (t_val[1] == 'x' || t_val[1] == 'X')) {
+          i = 2;
+        }
+
+        uint64_t u = 0;
+        for (; i < t_end; ++i)
+        {
+          const char c = t_val[i];
+          uint64_t digit;
+          if (c >= '0' && c <= '9') {
+            digit = static_cast<uint64_t>(c - '0');
+          } else if (c >= 'a' && c <= 'f') {
+            digit = static_cast<uint64_t>(c - 'a' + 10);
+          } else if (c >= 'A' && c <= 'F') {
+            digit = static_cast<uint64_t>(c - 'A' + 10);
+          } else {
+            break;
+          }
+
+          if (digit >= t_base) {
+            break;
+          }
+
+          if (u > (std::numeric_limits<uint64_t>::max() - digit) / t_base) {
+            return std::numeric_limits<uint64_t>::max();
+          }
+          u = u * t_base + digit;
+        }
+        return u;
+      }
+
+      /// Converts a value read by parse_digits to T, saturating like a stream would
+      template<typename T>
+      static Boxed_Value const_int(uint64_t t_u)
+      {
+        return const_var(t_u > static_cast<uint64_t>(std::numeric_limits<T>::max()) ? std::numeric_limits<T>::max() : static_cast<T>(t_u));
+      }
+
       template<typename IntType>
       static Boxed_Value buildInt(const IntType &t_type, const std::string &t_val)
       {
@@ -167,12 +212,8 @@ namespace chaiscript
           }
         }
 
-        std::stringstream ss(t_val.substr(0, i));
-        ss >> t_type;
-
-        std::stringstream testu(t_val.substr(0, i));
-        uint64_t u;
-        testu >> t_type >> u;
+        // the literal is read once, by hand, rather than through a pair of stringstreams
+        const uint64_t u = parse_digits(t_val, i, t_type == &std::hex ? 16 : (t_type == &std::oct ? 8 : 10));
 
         bool unsignedrequired = false;
 
@@ -227,32 +268,20 @@ namespace chaiscript
         {
           if (longlong_)
           {
-            uint64_t val;
-            ss >> val;
-            return const_var(val);
+            return const_int<uint64_t>(u);
           } else if (long_) {
-            unsigned long val;
-            ss >> val;
-            return const_var(val);
+            return const_int<unsigned long>(u);
           } else {
-            unsigned int val;
-            ss >> val;
-            return const_var(val);
+            return const_int<unsigned int>(u);
           }
         } else {
           if (longlong_)
           {
-            int64_t val;
-            ss >> val;
-            return const_var(val);
+            return const_int<int64_t>(u);
           } else if (long_) {
-            long val;
-            ss >> val;
-            return const_var(val);
+            return const_int<long>(u);
           } else {
-            int val;
-            ss >> val;
-            return const_var(val);
+            return const_int<int>(u);
           }
         }
       }